@@ -0,0 +1,329 @@
+// alphabeta.c
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "alphabeta.h"
+#include "game_rules.h"
+
+#define MAX_DEPTH 64       // en plies (un movimiento de un jugador)
+#define TT_BITS 20         // 2^20 entradas de 16 bytes
+#define TT_SIZE (1 << TT_BITS)
+#define CHECK_EVERY 1024   // nodos entre cada consulta del reloj
+#define INF (INT_MAX / 2)
+
+#define NO_MOVE 255
+#define TIE 2 // dueño de una celda a la que los dos llegan a la vez
+
+typedef enum {
+    BOUND_EXACT,
+    BOUND_LOWER, // el valor real es >= value (hubo corte beta)
+    BOUND_UPPER, // el valor real es <= value (ningún movimiento superó alfa)
+} Bound;
+
+typedef struct {
+    uint64_t key;
+    int value;
+    short depth;
+    unsigned char bound;
+    unsigned char move;
+} TTEntry;
+
+static int width = 0;
+static int height = 0;
+
+// Claves de Zobrist: una por celda ocupada, una por celda y jugador para las posiciones y una para el turno.
+// Las celdas solo pasan de libres a ocupadas y sus valores dependen de la semilla, así que alcanza con la ocupación.
+static uint64_t* occupied_key = NULL;
+static uint64_t* position_key[2] = { NULL, NULL };
+static uint64_t side_key = 0;
+
+static TTEntry* table = NULL;
+
+// Búsqueda en curso. Jugador 0 soy yo, 1 el rival (pos = -1 si no hay rival que mirar).
+static cell_t* board = NULL;
+static int pos[2];
+static uint64_t hash = 0;
+static struct timespec deadline;
+static unsigned long nodes = 0;
+static bool aborted = false;
+
+// Territorio de Voronoi: marcas con época para no limpiar entre evaluaciones
+static unsigned int* stamp = NULL;
+static int* distance = NULL;
+static unsigned char* owner = NULL;
+static int* queue = NULL;
+static unsigned int epoch = 0;
+
+static uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+bool alphabeta_init(int w, int h) {
+    width = w;
+    height = h;
+    size_t cells = (size_t)w * h;
+
+    occupied_key = malloc(sizeof(uint64_t) * cells);
+    position_key[0] = malloc(sizeof(uint64_t) * cells);
+    position_key[1] = malloc(sizeof(uint64_t) * cells);
+    table = calloc(TT_SIZE, sizeof(TTEntry));
+    board = malloc(sizeof(cell_t) * cells);
+    stamp = calloc(cells, sizeof(unsigned int));
+    distance = malloc(sizeof(int) * cells);
+    owner = malloc(cells);
+    queue = malloc(sizeof(int) * cells);
+    if (occupied_key == NULL || position_key[0] == NULL || position_key[1] == NULL || table == NULL ||
+        board == NULL || stamp == NULL || distance == NULL || owner == NULL || queue == NULL) {
+        return false;
+    }
+
+    uint64_t seed = 0x5EED;
+    for (size_t i = 0; i < cells; i++) {
+        occupied_key[i] = splitmix64(&seed);
+        position_key[0][i] = splitmix64(&seed);
+        position_key[1][i] = splitmix64(&seed);
+    }
+    side_key = splitmix64(&seed);
+    return true;
+}
+
+void alphabeta_free() {
+    free(occupied_key);
+    free(position_key[0]);
+    free(position_key[1]);
+    free(table);
+    free(board);
+    free(stamp);
+    free(distance);
+    free(owner);
+    free(queue);
+}
+
+static bool deadline_passed() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec);
+}
+
+static int neighbour(int index, int dir) {
+    int x = index % width + dx[dir];
+    int y = index / width + dy[dir];
+    if (x < 0 || y < 0 || x >= width || y >= height) return -1;
+    return y * width + x;
+}
+
+// Movimientos legales del jugador `side`, el de la tabla primero y después por valor de la celda
+static int generate_moves(int side, unsigned char tt_move, unsigned char moves[DIRECTIONS]) {
+    int count = 0;
+    if (pos[side] < 0) return 0;
+
+    int values[DIRECTIONS];
+    for (int dir = 0; dir < DIRECTIONS; dir++) {
+        int next = neighbour(pos[side], dir);
+        if (next < 0 || board[next] <= 0) continue;
+
+        int value = dir == tt_move ? 10 : board[next];
+        int i = count++;
+        while (i > 0 && values[i - 1] < value) {
+            values[i] = values[i - 1];
+            moves[i] = moves[i - 1];
+            i--;
+        }
+        values[i] = value;
+        moves[i] = dir;
+    }
+    return count;
+}
+
+static bool can_move(int side) {
+    if (pos[side] < 0) return false;
+    for (int dir = 0; dir < DIRECTIONS; dir++) {
+        int next = neighbour(pos[side], dir);
+        if (next >= 0 && board[next] > 0) return true;
+    }
+    return false;
+}
+
+// Suma de los valores de las celdas a las que `side` llega estrictamente antes que el otro, menos las del otro
+static int evaluate(int side) {
+    if (++epoch == 0) {
+        memset(stamp, 0, sizeof(unsigned int) * width * height);
+        epoch = 1;
+    }
+
+    int front = 0, rear = 0;
+    for (int s = 0; s < 2; s++) {
+        if (pos[s] < 0) continue;
+        stamp[pos[s]] = epoch;
+        distance[pos[s]] = 0;
+        owner[pos[s]] = s;
+        queue[rear++] = pos[s];
+    }
+
+    int territory[3] = { 0, 0, 0 };
+    while (front < rear) {
+        int cell = queue[front++];
+        for (int dir = 0; dir < DIRECTIONS; dir++) {
+            int next = neighbour(cell, dir);
+            if (next < 0 || board[next] <= 0) continue;
+
+            if (stamp[next] != epoch) {
+                stamp[next] = epoch;
+                distance[next] = distance[cell] + 1;
+                owner[next] = owner[cell];
+                queue[rear++] = next;
+                territory[owner[next]] += board[next];
+            } else if (distance[next] == distance[cell] + 1 && owner[next] != owner[cell] && owner[next] != TIE) {
+                territory[owner[next]] -= board[next];
+                owner[next] = TIE;
+            }
+        }
+    }
+    return territory[side] - territory[1 - side];
+}
+
+static int occupy(int side, int next) {
+    int value = board[next];
+    hash ^= position_key[side][pos[side]] ^ position_key[side][next] ^ occupied_key[next];
+    board[next] = 0;
+    pos[side] = next;
+    return value;
+}
+
+static void release(int side, int previous, int next, int value) {
+    board[next] = value;
+    pos[side] = previous;
+    hash ^= position_key[side][previous] ^ position_key[side][next] ^ occupied_key[next];
+}
+
+// Negamax: el valor es, desde el punto de vista de `side`, lo que suma de acá en adelante menos lo que
+// suma el otro, más la diferencia de territorio en las hojas. No depende del camino, así que se puede
+// guardar en la tabla aunque se llegue a la misma posición en otro orden.
+static int negamax(int depth, int alpha, int beta, int side) {
+    if ((++nodes % CHECK_EVERY) == 0 && deadline_passed()) {
+        aborted = true;
+    }
+    if (aborted) return 0;
+
+    if (depth == 0) return evaluate(side);
+
+    int alpha_start = alpha;
+    unsigned char tt_move = NO_MOVE;
+    TTEntry* entry = &table[hash & (TT_SIZE - 1)];
+    if (entry->key == hash) {
+        tt_move = entry->move;
+        if (entry->depth >= depth) {
+            if (entry->bound == BOUND_EXACT) return entry->value;
+            if (entry->bound == BOUND_LOWER && entry->value >= beta) return entry->value;
+            if (entry->bound == BOUND_UPPER && entry->value <= alpha) return entry->value;
+        }
+    }
+
+    unsigned char moves[DIRECTIONS];
+    int count = generate_moves(side, tt_move, moves);
+    if (count == 0) {
+        // Sin movimientos: si el otro tampoco puede, no quedan puntos en juego; si no, pasa el turno
+        if (!can_move(1 - side)) return 0;
+        hash ^= side_key;
+        int value = -negamax(depth, -beta, -alpha, 1 - side);
+        hash ^= side_key;
+        return value;
+    }
+
+    int best = -INF;
+    unsigned char best_move = moves[0];
+    for (int i = 0; i < count; i++) {
+        int previous = pos[side];
+        int next = neighbour(previous, moves[i]);
+        int gained = occupy(side, next);
+        hash ^= side_key;
+        int value = gained - negamax(depth - 1, gained - beta, gained - alpha, 1 - side);
+        hash ^= side_key;
+        release(side, previous, next, gained);
+
+        if (aborted) return 0;
+        if (value > best) {
+            best = value;
+            best_move = moves[i];
+        }
+        if (best > alpha) alpha = best;
+        if (alpha >= beta) break;
+    }
+
+    // Reemplazo siempre: con profundización iterativa lo más reciente es lo más útil
+    entry->key = hash;
+    entry->value = best;
+    entry->depth = depth;
+    entry->move = best_move;
+    entry->bound = best <= alpha_start ? BOUND_UPPER : best >= beta ? BOUND_LOWER : BOUND_EXACT;
+    return best;
+}
+
+unsigned char alphabeta_get_movement(const cell_t* shared_board, const SearchPlayer players[], int player_count, int me, int budget_ms) {
+    memcpy(board, shared_board, sizeof(cell_t) * width * height);
+
+    // El rival que importa es el más cercano que todavía se puede mover
+    int opponent = -1;
+    int opponent_distance = INT_MAX;
+    for (int i = 0; i < player_count; i++) {
+        if (i == me || players[i].blocked) continue;
+        int distance_x = abs(players[i].x - players[me].x);
+        int distance_y = abs(players[i].y - players[me].y);
+        int distance = distance_x > distance_y ? distance_x : distance_y;
+        if (distance < opponent_distance) {
+            opponent_distance = distance;
+            opponent = i;
+        }
+    }
+    pos[0] = players[me].y * width + players[me].x;
+    pos[1] = opponent < 0 ? -1 : players[opponent].y * width + players[opponent].x;
+
+    unsigned char moves[DIRECTIONS];
+    int count = generate_moves(0, NO_MOVE, moves);
+    if (count == 0) return 255;
+    if (count == 1) return moves[0];
+
+    hash = 0;
+    int free_cells = 0;
+    for (int i = 0; i < width * height; i++) {
+        if (board[i] <= 0) {
+            hash ^= occupied_key[i];
+        } else {
+            free_cells++;
+        }
+    }
+    hash ^= position_key[0][pos[0]];
+    if (pos[1] >= 0) hash ^= position_key[1][pos[1]];
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += budget_ms / 1000;
+    deadline.tv_nsec += (budget_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    nodes = 0;
+    aborted = false;
+
+    // Cada profundidad completa deja su mejor movimiento en la entrada de la raíz; si se corta a la mitad
+    // se queda el de la anterior
+    unsigned char best_move = moves[0];
+    uint64_t root_hash = hash;
+    for (int depth = 1; depth <= MAX_DEPTH && depth <= 2 * free_cells; depth++) {
+        negamax(depth, -INF, INF, 0);
+        if (aborted) break;
+
+        TTEntry* entry = &table[root_hash & (TT_SIZE - 1)];
+        if (entry->key == root_hash && entry->move != NO_MOVE) {
+            best_move = entry->move;
+        }
+    }
+    return best_move;
+}
@@ -0,0 +1,23 @@
+// alphabeta.h
+#ifndef ALPHABETA_H
+#define ALPHABETA_H
+
+#include <stdbool.h>
+
+#include "game_state.h"
+#include "search.h"
+
+// Minimax con poda alfa-beta entre el jugador y el rival más cercano (los demás quedan como obstáculos
+// fijos), por profundización iterativa hasta que se acaba el tiempo. Las hojas se evalúan por territorio
+// de Voronoi: cada celda libre suma para el jugador que llega antes. Las posiciones se identifican con un
+// hash de Zobrist (celdas ocupadas, posición de los dos jugadores y a quién le toca) que indexa una tabla
+// de transposición de tamaño fijo.
+
+bool alphabeta_init(int width, int height);
+void alphabeta_free();
+
+// Busca durante budget_ms milisegundos y devuelve la mejor dirección de la última profundidad completa,
+// o 255 si el jugador `me` no tiene movimientos.
+unsigned char alphabeta_get_movement(const cell_t* board, const SearchPlayer players[], int player_count, int me, int budget_ms);
+
+#endif // ALPHABETA_H
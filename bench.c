@@ -0,0 +1,161 @@
+// bench.c
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+uint64_t bench_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void bench_game_init(BenchGame* game, unsigned int seed) {
+    memset(game, 0, sizeof(BenchGame));
+    game->seed = seed;
+}
+
+void bench_game_free(BenchGame* game) {
+    free(game->latency.values);
+    free(game->hold.values);
+}
+
+void samples_add(Samples* samples, uint64_t value, size_t times) {
+    if (samples->count + times > samples->capacity) {
+        size_t capacity = samples->capacity ? samples->capacity : 1024;
+        while (capacity < samples->count + times) capacity *= 2;
+
+        uint64_t* values = realloc(samples->values, capacity * sizeof(uint64_t));
+        if (values == NULL) return; // se pierden las muestras, no la partida
+        samples->values = values;
+        samples->capacity = capacity;
+    }
+    for (size_t i = 0; i < times; i++) {
+        samples->values[samples->count++] = value;
+    }
+    samples->sorted = false;
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+uint64_t samples_percentile(Samples* samples, double p) {
+    if (samples->count == 0) return 0;
+    if (!samples->sorted) {
+        qsort(samples->values, samples->count, sizeof(uint64_t), compare_u64);
+        samples->sorted = true;
+    }
+    size_t index = (size_t)(p / 100.0 * (samples->count - 1) + 0.5);
+    return samples->values[index];
+}
+
+static void samples_merge(Samples* dst, const Samples* src) {
+    for (size_t i = 0; i < src->count; i++) {
+        samples_add(dst, src->values[i], 1);
+    }
+}
+
+static double to_ms(uint64_t ns) {
+    return ns / 1e6;
+}
+
+static double to_us(uint64_t ns) {
+    return ns / 1e3;
+}
+
+static double moves_per_sec(unsigned int moves, uint64_t ns) {
+    return ns ? moves / (ns / 1e9) : 0;
+}
+
+// Escribe text como string de JSON: entre comillas, escapando comillas, barras y caracteres de control
+static void write_json_string(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const unsigned char* c = (const unsigned char*)text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        } else if (*c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void write_json_game(FILE* out, BenchGame* game, const char* indent) {
+    fprintf(out, "%s\"wall_ms\": %.3f,\n", indent, to_ms(game->wall_ns));
+    fprintf(out, "%s\"startup_ms\": %.3f,\n", indent, to_ms(game->startup_ns));
+    fprintf(out, "%s\"game_ms\": %.3f,\n", indent, to_ms(game->game_ns));
+    fprintf(out, "%s\"moves\": %u,\n", indent, game->moves);
+    fprintf(out, "%s\"valid_moves\": %u,\n", indent, game->valid_moves);
+    fprintf(out, "%s\"invalid_moves\": %u,\n", indent, game->invalid_moves);
+    fprintf(out, "%s\"discarded_moves\": %u,\n", indent, game->discarded_moves);
+    fprintf(out, "%s\"moves_per_sec\": %.1f,\n", indent, moves_per_sec(game->moves, game->game_ns));
+    fprintf(out, "%s\"latency_us\": {\"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f},\n", indent,
+            to_us(samples_percentile(&game->latency, 50)), to_us(samples_percentile(&game->latency, 90)),
+            to_us(samples_percentile(&game->latency, 99)), to_us(samples_percentile(&game->latency, 100)));
+    fprintf(out, "%s\"hold_us\": {\"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"max\": %.1f}\n", indent,
+            to_us(samples_percentile(&game->hold, 50)), to_us(samples_percentile(&game->hold, 90)),
+            to_us(samples_percentile(&game->hold, 99)), to_us(samples_percentile(&game->hold, 100)));
+}
+
+static void write_csv_row(FILE* out, const char* label, BenchGame* game) {
+    fprintf(out, "%s,%.3f,%.3f,%.3f,%u,%u,%u,%u,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", label,
+            to_ms(game->wall_ns), to_ms(game->startup_ns), to_ms(game->game_ns),
+            game->moves, game->valid_moves, game->invalid_moves, game->discarded_moves, moves_per_sec(game->moves, game->game_ns),
+            to_us(samples_percentile(&game->latency, 50)), to_us(samples_percentile(&game->latency, 90)),
+            to_us(samples_percentile(&game->latency, 99)), to_us(samples_percentile(&game->latency, 100)),
+            to_us(samples_percentile(&game->hold, 50)), to_us(samples_percentile(&game->hold, 90)),
+            to_us(samples_percentile(&game->hold, 99)), to_us(samples_percentile(&game->hold, 100)));
+}
+
+void bench_write_report(FILE* out, BenchFormat format, BenchGame* games, int game_count, const char* players[], int player_count) {
+    // Agregado de todas las partidas
+    BenchGame total;
+    bench_game_init(&total, 0);
+    for (int i = 0; i < game_count; i++) {
+        total.wall_ns += games[i].wall_ns;
+        total.startup_ns += games[i].startup_ns;
+        total.game_ns += games[i].game_ns;
+        total.moves += games[i].moves;
+        total.valid_moves += games[i].valid_moves;
+        total.invalid_moves += games[i].invalid_moves;
+        total.discarded_moves += games[i].discarded_moves;
+        samples_merge(&total.latency, &games[i].latency);
+        samples_merge(&total.hold, &games[i].hold);
+    }
+
+    if (format == BENCH_CSV) {
+        fprintf(out, "seed,wall_ms,startup_ms,game_ms,moves,valid_moves,invalid_moves,discarded_moves,moves_per_sec,"
+                     "latency_p50_us,latency_p90_us,latency_p99_us,latency_max_us,"
+                     "hold_p50_us,hold_p90_us,hold_p99_us,hold_max_us\n");
+        for (int i = 0; i < game_count; i++) {
+            char label[16];
+            snprintf(label, sizeof(label), "%u", games[i].seed);
+            write_csv_row(out, label, &games[i]);
+        }
+        write_csv_row(out, "total", &total);
+    } else {
+        fprintf(out, "{\n  \"players\": [");
+        for (int i = 0; i < player_count; i++) {
+            if (i) fprintf(out, ", ");
+            write_json_string(out, players[i]);
+        }
+        fprintf(out, "],\n  \"games\": [\n");
+        for (int i = 0; i < game_count; i++) {
+            fprintf(out, "    {\n      \"seed\": %u,\n", games[i].seed);
+            write_json_game(out, &games[i], "      ");
+            fprintf(out, "    }%s\n", i + 1 < game_count ? "," : "");
+        }
+        fprintf(out, "  ],\n  \"total\": {\n    \"games\": %d,\n", game_count);
+        write_json_game(out, &total, "    ");
+        fprintf(out, "  }\n}\n");
+    }
+
+    bench_game_free(&total);
+}
@@ -0,0 +1,49 @@
+// bench.h
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Muestras de tiempos en nanosegundos, crece a medida que se agregan
+typedef struct {
+    uint64_t* values;
+    size_t count;
+    size_t capacity;
+    bool sorted;
+} Samples;
+
+// Métricas de una partida corrida en modo benchmark
+typedef struct {
+    unsigned int seed;
+    uint64_t wall_ns;       // desde que se crea la memoria compartida hasta que terminan todos los hijos
+    uint64_t startup_ns;    // hasta que se publica el estado inicial (players y vista creados)
+    uint64_t game_ns;       // desde la publicación inicial hasta que termina el juego
+    unsigned int moves;     // movimientos procesados (válidos + inválidos)
+    unsigned int valid_moves;
+    unsigned int invalid_moves;
+    unsigned int discarded_moves; // movimientos con versión que llegaron viejos o reemplazados (no se aplicaron)
+    Samples latency;        // publicación del estado -> llegada del movimiento al máster
+    Samples hold;           // tiempo con el estado tomado para escribir (sección crítica)
+} BenchGame;
+
+typedef enum {
+    BENCH_JSON,
+    BENCH_CSV,
+} BenchFormat;
+
+uint64_t bench_now_ns();
+
+void bench_game_init(BenchGame* game, unsigned int seed);
+void bench_game_free(BenchGame* game);
+
+void samples_add(Samples* samples, uint64_t value, size_t times);
+// Percentil p (0 a 100) de las muestras, 0 si no hay ninguna. Ordena las muestras la primera vez.
+uint64_t samples_percentile(Samples* samples, double p);
+
+// Escribe el reporte de todas las partidas y el agregado
+void bench_write_report(FILE* out, BenchFormat format, BenchGame* games, int game_count, const char* players[], int player_count);
+
+#endif // BENCH_H
@@ -0,0 +1,167 @@
+// bitboard.c
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitboard.h"
+#include "game_rules.h"
+
+bool bb_init(Bitboard* bb, int width, int height) {
+    bb->width = width;
+    bb->height = height;
+    bb->words = (width + 63) / 64;
+    bb->bits = calloc((size_t)bb->words * height, sizeof(uint64_t));
+    return bb->bits != NULL;
+}
+
+void bb_free(Bitboard* bb) {
+    free(bb->bits);
+    bb->bits = NULL;
+}
+
+void bb_clear(Bitboard* bb) {
+    memset(bb->bits, 0, sizeof(uint64_t) * bb->words * bb->height);
+}
+
+void bb_load_board(Bitboard* free_cells, Bitboard planes[BB_PLANES], const cell_t* board) {
+    int width = free_cells->width;
+    int height = free_cells->height;
+
+    bb_clear(free_cells);
+    for (int k = 0; k < BB_PLANES; k++) {
+        bb_clear(&planes[k]);
+    }
+
+    for (int y = 0; y < height; y++) {
+        const cell_t* cells = board + y * width;
+        for (int x = 0; x < width; x++) {
+            int value = cells[x];
+            if (value <= 0) continue;
+
+            bb_set(free_cells, x, y);
+            for (int k = 0; k < BB_PLANES; k++) {
+                if (value & (1 << k)) {
+                    bb_set(&planes[k], x, y);
+                }
+            }
+        }
+    }
+}
+
+void bb_take_cell(Bitboard* free_cells, Bitboard planes[BB_PLANES], int index) {
+    int x = index % free_cells->width;
+    int y = index / free_cells->width;
+    bb_reset(free_cells, x, y);
+    for (int k = 0; k < BB_PLANES; k++) {
+        bb_reset(&planes[k], x, y);
+    }
+}
+
+unsigned char bb_free_neighbours(const Bitboard* free_cells, int x, int y) {
+    unsigned char mask = 0;
+    for (int dir = 0; dir < DIRECTIONS; dir++) {
+        int nx = x + dx[dir];
+        int ny = y + dy[dir];
+        if (nx < 0 || ny < 0 || nx >= free_cells->width || ny >= free_cells->height) continue;
+        if (bb_get(free_cells, nx, ny)) {
+            mask |= 1 << dir;
+        }
+    }
+    return mask;
+}
+
+int bb_count(const Bitboard* bb) {
+    int count = 0;
+    int total = bb->words * bb->height;
+    for (int i = 0; i < total; i++) {
+        count += __builtin_popcountll(bb->bits[i]);
+    }
+    return count;
+}
+
+int bb_weighted_count(const Bitboard* region, const Bitboard planes[BB_PLANES]) {
+    int sum = 0;
+    int total = region->words * region->height;
+    for (int k = 0; k < BB_PLANES; k++) {
+        int count = 0;
+        for (int i = 0; i < total; i++) {
+            count += __builtin_popcountll(region->bits[i] & planes[k].bits[i]);
+        }
+        sum += count << k;
+    }
+    return sum;
+}
+
+// Dilatación horizontal de una fila: cada bit se corre a izquierda y derecha, pasando el acarreo entre palabras
+static void dilate_row(uint64_t* out, const uint64_t* in, int words) {
+    for (int w = 0; w < words; w++) {
+        uint64_t left = in[w] << 1 | (w > 0 ? in[w - 1] >> 63 : 0);
+        uint64_t right = in[w] >> 1 | (w + 1 < words ? in[w + 1] << 63 : 0);
+        out[w] = in[w] | left | right;
+    }
+}
+
+// Hace crecer la fila y de la región con sus vecinos (ya crecidos o no) y la recorta a las celdas libres.
+// Devuelve true si la fila cambió.
+static bool grow_row(Bitboard* region, const Bitboard* free_cells, int y, uint64_t* scratch) {
+    int words = region->words;
+    uint64_t* row = bb_row(region, y);
+    const uint64_t* above = y > 0 ? bb_row(region, y - 1) : NULL;
+    const uint64_t* below = y + 1 < region->height ? bb_row(region, y + 1) : NULL;
+
+    for (int w = 0; w < words; w++) {
+        scratch[w] = row[w] | (above ? above[w] : 0) | (below ? below[w] : 0);
+    }
+    dilate_row(scratch + words, scratch, words);
+
+    const uint64_t* free_row = bb_row(free_cells, y);
+    uint64_t diff = 0;
+    for (int w = 0; w < words; w++) {
+        uint64_t grown = scratch[words + w] & free_row[w];
+        diff |= grown ^ row[w];
+        row[w] = grown;
+    }
+    return diff != 0;
+}
+
+static bool row_is_empty(const Bitboard* bb, int y) {
+    const uint64_t* row = bb_row(bb, y);
+    for (int w = 0; w < bb->words; w++) {
+        if (row[w]) return false;
+    }
+    return true;
+}
+
+int bb_flood(Bitboard* region, const Bitboard* free_cells, int x, int y) {
+    bb_clear(region);
+    if (!bb_get(free_cells, x, y)) return 0;
+    bb_set(region, x, y);
+
+    uint64_t scratch[2 * region->words];
+    int height = region->height;
+    int top = y, bottom = y; // franja de filas que ya tienen celdas de la región
+    bool changed = true;
+
+    // Barridas hacia abajo y hacia arriba, actualizando en el lugar: cada barrida ya usa las filas
+    // crecidas en la misma pasada, así una región alargada se llena en pocas iteraciones
+    while (changed) {
+        changed = false;
+
+        for (int row = top > 0 ? top - 1 : 0; row <= bottom + 1 && row < height; row++) {
+            if (grow_row(region, free_cells, row, scratch)) {
+                changed = true;
+                if (row > bottom && !row_is_empty(region, row)) bottom = row;
+                if (row < top && !row_is_empty(region, row)) top = row;
+            }
+        }
+
+        for (int row = bottom + 1 < height ? bottom + 1 : bottom; row >= top - 1 && row >= 0; row--) {
+            if (grow_row(region, free_cells, row, scratch)) {
+                changed = true;
+                if (row > bottom && !row_is_empty(region, row)) bottom = row;
+                if (row < top && !row_is_empty(region, row)) top = row;
+            }
+        }
+    }
+
+    return bb_count(region);
+}
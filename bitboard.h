@@ -0,0 +1,65 @@
+// bitboard.h
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game_state.h"
+
+// Tablero empaquetado: un bit por celda, cada fila ocupa `words` palabras de 64 bits.
+// El bit (x % 64) de la palabra (x / 64) de la fila y corresponde a la celda (x, y).
+// Los bits de relleno al final de cada fila quedan siempre en 0.
+typedef struct {
+    int width;
+    int height;
+    int words;      // palabras de 64 bits por fila
+    uint64_t* bits; // height * words palabras, fila 0 primero
+} Bitboard;
+
+// Los valores de las celdas libres (1 a 9) se guardan en 4 planos de bits,
+// el plano k tiene prendido el bit de cada celda cuyo valor tiene el bit k en 1
+#define BB_PLANES 4
+
+bool bb_init(Bitboard* bb, int width, int height);
+void bb_free(Bitboard* bb);
+void bb_clear(Bitboard* bb);
+
+static inline uint64_t* bb_row(const Bitboard* bb, int y) {
+    return bb->bits + (long)y * bb->words;
+}
+
+static inline bool bb_get(const Bitboard* bb, int x, int y) {
+    return (bb_row(bb, y)[x >> 6] >> (x & 63)) & 1;
+}
+
+static inline void bb_set(Bitboard* bb, int x, int y) {
+    bb_row(bb, y)[x >> 6] |= (uint64_t)1 << (x & 63);
+}
+
+static inline void bb_reset(Bitboard* bb, int x, int y) {
+    bb_row(bb, y)[x >> 6] &= ~((uint64_t)1 << (x & 63));
+}
+
+// Arma el bitboard de celdas libres y los planos de valores a partir del tablero del juego
+void bb_load_board(Bitboard* free_cells, Bitboard planes[BB_PLANES], const cell_t* board);
+
+// Marca como ocupada la celda `index` (y * width + x): para poner al día lo que armó bb_load_board
+// con cada movimiento nuevo sin recorrer el tablero entero
+void bb_take_cell(Bitboard* free_cells, Bitboard planes[BB_PLANES], int index);
+
+// Devuelve una máscara con el bit d prendido si la celda vecina en la dirección d está libre
+// (mismas direcciones que el protocolo: 0 arriba, 1 arriba-derecha, ..., 7 arriba-izquierda)
+unsigned char bb_free_neighbours(const Bitboard* free_cells, int x, int y);
+
+// Cantidad de celdas prendidas
+int bb_count(const Bitboard* bb);
+
+// Suma de los valores de las celdas prendidas en `region`, usando los planos de valores
+int bb_weighted_count(const Bitboard* region, const Bitboard planes[BB_PLANES]);
+
+// Deja en `region` la región libre (8-conexa) que contiene a (x, y) y devuelve su tamaño.
+// Si (x, y) no está libre la región queda vacía.
+int bb_flood(Bitboard* region, const Bitboard* free_cells, int x, int y);
+
+#endif // BITBOARD_H
@@ -0,0 +1,417 @@
+// game_ext.c
+#define _GNU_SOURCE // syscall()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "game_ext.h"
+
+bool ns_set(const char* ns) {
+    size_t len = strlen(ns);
+    if (len == 0 || len >= NS_MAX) return false;
+    for (size_t i = 0; i < len; i++) {
+        if (!isalnum((unsigned char)ns[i]) && ns[i] != '_' && ns[i] != '-') return false;
+    }
+    return setenv(NS_ENV, ns, 1) == 0;
+}
+
+const char* ns_get() {
+    const char* ns = getenv(NS_ENV);
+    return ns != NULL && ns[0] != '\0' ? ns : NULL;
+}
+
+void ns_name(char* out, size_t size, const char* base) {
+    const char* ns = ns_get();
+    if (ns == NULL) {
+        snprintf(out, size, "%s", base);
+    } else {
+        snprintf(out, size, "%s_%s", base, ns);
+    }
+}
+
+void ns_fifo_path(char* out, size_t size, int player) {
+    const char* ns = ns_get();
+    if (ns == NULL) {
+        snprintf(out, size, "/tmp/pipe_player_%d", player);
+    } else {
+        snprintf(out, size, "/tmp/pipe_%s_player_%d", ns, player);
+    }
+}
+
+static ExtReaders* readers = NULL; // /game_ext_readers del GameExt mapeado en este proceso
+
+static ExtReaders* readers_create() {
+    char name[NS_NAME_MAX];
+    ns_name(name, sizeof(name), SHM_EXT_READERS);
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (fd < 0) {
+        perror("shm_open ext readers");
+        return NULL;
+    }
+    // Si el máster no es root no puede cambiar el dueño, pero entonces los hijos tampoco cambian de
+    // usuario (corren con el suyo) y con 0600 igual pueden abrirlo
+    fchmod(fd, 0600);
+    if (fchown(fd, EXT_READER_UID, -1) == -1 && getuid() == 0) {
+        perror("fchown ext readers");
+    }
+    if (ftruncate(fd, sizeof(ExtReaders)) == -1) {
+        perror("ftruncate ext readers");
+        close(fd);
+        return NULL;
+    }
+    ExtReaders* mapped = mmap(NULL, sizeof(ExtReaders), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        perror("mmap ext readers");
+        return NULL;
+    }
+    memset(mapped, 0, sizeof(ExtReaders));
+    return mapped;
+}
+
+GameExt* ext_create(SyncMode mode, unsigned int cell_size, unsigned int map_flags) {
+    char name[NS_NAME_MAX];
+    ns_name(name, sizeof(name), SHM_EXT);
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("shm_open ext");
+        return NULL;
+    }
+    fchmod(fd, 0644); // por si quedó uno viejo con otros permisos: solo el máster escribe
+    if (ftruncate(fd, sizeof(GameExt)) == -1) {
+        perror("ftruncate ext");
+        close(fd);
+        return NULL;
+    }
+    GameExt* ext = mmap(NULL, sizeof(GameExt), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ext == MAP_FAILED) {
+        perror("mmap ext");
+        return NULL;
+    }
+    readers = readers_create();
+    if (readers == NULL) {
+        munmap(ext, sizeof(GameExt));
+        return NULL;
+    }
+
+    ext->master_pid = getpid();
+    ext->sync_mode = mode;
+    ext->cell_size = cell_size;
+    ext->map_flags = map_flags;
+    ext->seq = 1;
+    ext->generation = 0;
+    ext->journal_head = 0;
+    ext->version = 0;
+    ext->view_fps = 0;
+    ext->buffer_count = 0;
+    ext->front = 0;
+    memset(ext->buffer_version, 0, sizeof(ext->buffer_version));
+    memset(ext->buffer_journal, 0, sizeof(ext->buffer_journal));
+    __atomic_store_n(&ext->magic, EXT_MAGIC, __ATOMIC_RELEASE);
+    return ext;
+}
+
+void ext_destroy(GameExt* ext) {
+    if (ext == NULL) return;
+    if (munmap(ext, sizeof(GameExt)) == -1) {
+        perror("munmap ext");
+    }
+    munmap(readers, sizeof(ExtReaders));
+    readers = NULL;
+    char name[NS_NAME_MAX];
+    ns_name(name, sizeof(name), SHM_EXT);
+    if (shm_unlink(name) == -1) {
+        perror("shm_unlink ext");
+    }
+    ns_name(name, sizeof(name), SHM_EXT_READERS);
+    if (shm_unlink(name) == -1) {
+        perror("shm_unlink ext readers");
+    }
+}
+
+GameExt* ext_attach(unsigned int cell_size) {
+    char name[NS_NAME_MAX];
+    ns_name(name, sizeof(name), SHM_EXT);
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    GameExt* ext = mmap(NULL, sizeof(GameExt), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ext == MAP_FAILED) {
+        return NULL;
+    }
+
+    if (__atomic_load_n(&ext->magic, __ATOMIC_ACQUIRE) != EXT_MAGIC || ext->master_pid != getppid()) {
+        munmap(ext, sizeof(GameExt));
+        return NULL;
+    }
+
+    // El máster crea /game_ext_readers antes de publicar el magic de /game_ext
+    ns_name(name, sizeof(name), SHM_EXT_READERS);
+    fd = shm_open(name, O_RDWR, 0);
+    readers = fd < 0 ? MAP_FAILED : mmap(NULL, sizeof(ExtReaders), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (fd >= 0) close(fd);
+    if (readers == MAP_FAILED) {
+        perror("ext readers");
+        readers = NULL;
+        munmap(ext, sizeof(GameExt));
+        return NULL;
+    }
+    if (ext->cell_size != cell_size) {
+        fprintf(stderr, "El máster usa celdas de %u bytes y este binario de %u, hay que compilar todo igual (make COMPACT=...)\n",
+                ext->cell_size, cell_size);
+        exit(1);
+    }
+    return ext;
+}
+
+void ext_detach(GameExt* ext) {
+    if (ext == NULL) return;
+    munmap(ext, sizeof(GameExt));
+    munmap(readers, sizeof(ExtReaders));
+    readers = NULL;
+}
+
+void ext_enable_move_messages(GameExt* ext) {
+    (void)ext;
+    pid_t me = getpid();
+    for (int i = 0; i < EXT_SENDERS_MAX; i++) {
+        pid_t expected = 0;
+        if (__atomic_compare_exchange_n(&readers->move_senders[i], &expected, me, false,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED) || expected == me) {
+            return;
+        }
+    }
+}
+
+bool ext_sends_move_messages(GameExt* ext, pid_t pid) {
+    (void)ext;
+    for (int i = 0; i < EXT_SENDERS_MAX; i++) {
+        pid_t sender = __atomic_load_n(&readers->move_senders[i], __ATOMIC_ACQUIRE);
+        if (sender == pid) return true;
+        if (sender == 0) return false;
+    }
+    return false;
+}
+
+size_t ext_state_map_size(size_t size, unsigned int map_flags) {
+    if (map_flags & EXT_HUGEPAGES) {
+        return (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+    return size;
+}
+
+void ext_prepare_mapping(void* addr, size_t size, unsigned int map_flags) {
+    if (map_flags & EXT_HUGEPAGES) {
+        // Tiene que ir antes del primer acceso; en tmpfs solo tiene efecto si
+        // /sys/kernel/mm/transparent_hugepage/shmem_enabled está en advise (o always)
+        madvise(addr, size, MADV_HUGEPAGE);
+    }
+    if (map_flags & EXT_PREFAULT) {
+        // mlock trae todas las páginas y además evita que se vayan a swap; si el límite de
+        // RLIMIT_MEMLOCK no alcanza, al menos se pagan los fallos de página ahora
+        if (mlock(addr, size) == -1) {
+            long page = sysconf(_SC_PAGESIZE);
+            volatile const char* bytes = addr;
+            for (size_t offset = 0; offset < size; offset += page) {
+                (void)bytes[offset];
+            }
+        }
+    }
+}
+
+size_t ext_buffer_stride(size_t state_size) {
+    return (state_size + 63) & ~(size_t)63;
+}
+
+void* ext_buffers_create(GameExt* ext, size_t stride) {
+    char name[NS_NAME_MAX];
+    ns_name(name, sizeof(name), SHM_BUFFERS);
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        perror("shm_open buffers");
+        return NULL;
+    }
+    size_t size = ext_state_map_size(stride * ext->buffer_count, ext->map_flags);
+    if (ftruncate(fd, size) == -1) {
+        perror("ftruncate buffers");
+        close(fd);
+        return NULL;
+    }
+    void* buffers = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (buffers == MAP_FAILED) {
+        perror("mmap buffers");
+        return NULL;
+    }
+    ext_prepare_mapping(buffers, size, ext->map_flags);
+    return buffers;
+}
+
+void* ext_buffers_attach(const GameExt* ext, size_t stride) {
+    char name[NS_NAME_MAX];
+    ns_name(name, sizeof(name), SHM_BUFFERS);
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    size_t size = ext_state_map_size(stride * ext->buffer_count, ext->map_flags);
+    void* buffers = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (buffers == MAP_FAILED) {
+        return NULL;
+    }
+    ext_prepare_mapping(buffers, size, ext->map_flags);
+    return buffers;
+}
+
+void ext_buffers_detach(void* buffers, const GameExt* ext, size_t stride) {
+    if (buffers == NULL) return;
+    munmap(buffers, ext_state_map_size(stride * ext->buffer_count, ext->map_flags));
+}
+
+void ext_buffers_destroy(void* buffers, const GameExt* ext, size_t stride) {
+    if (buffers == NULL) return;
+    ext_buffers_detach(buffers, ext, stride);
+    char name[NS_NAME_MAX];
+    ns_name(name, sizeof(name), SHM_BUFFERS);
+    if (shm_unlink(name) == -1) {
+        perror("shm_unlink buffers");
+    }
+}
+
+// El lector anota que va a copiar el buffer y después confirma que sigue al frente; el máster cambia
+// el frente y después mira si alguien anotó el buffer que quiere escribir. Con orden secuencial
+// alguno de los dos ve al otro: o el lector ve que el frente cambió y prueba de nuevo, o el máster
+// ve al lector y elige otro buffer.
+unsigned int ext_buffer_acquire(GameExt* ext, unsigned int* retries) {
+    for (;;) {
+        unsigned int index = __atomic_load_n(&ext->front, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&readers->buffer_readers[index], 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ext->front, __ATOMIC_SEQ_CST) == index) {
+            return index;
+        }
+        __atomic_sub_fetch(&readers->buffer_readers[index], 1, __ATOMIC_RELEASE);
+        if (retries) (*retries)++;
+    }
+}
+
+void ext_buffer_release(GameExt* ext, unsigned int index) {
+    __atomic_sub_fetch(&readers->buffer_readers[index], 1, __ATOMIC_RELEASE);
+}
+
+unsigned int ext_buffer_back(GameExt* ext) {
+    unsigned int front = ext->front;
+    for (unsigned int offset = 1; offset < ext->buffer_count; offset++) {
+        unsigned int index = (front + offset) % ext->buffer_count;
+        if (__atomic_load_n(&readers->buffer_readers[index], __ATOMIC_SEQ_CST) == 0) {
+            return index;
+        }
+    }
+    return EXT_NO_BUFFER; // todos los demás se están copiando
+}
+
+void ext_buffer_flip(GameExt* ext, unsigned int index) {
+    __atomic_store_n(&ext->front, index, __ATOMIC_SEQ_CST);
+}
+
+void ext_signal_ready(GameExt* ext) {
+    __atomic_add_fetch(&readers->ready, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &readers->ready, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+bool ext_wait_ready(GameExt* ext, unsigned int count, int timeout_ms) {
+    struct timespec now, deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    unsigned int ready;
+    while ((ready = __atomic_load_n(&readers->ready, __ATOMIC_SEQ_CST)) < count) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long remaining_ns = (deadline.tv_sec - now.tv_sec) * 1000000000L + (deadline.tv_nsec - now.tv_nsec);
+        if (remaining_ns <= 0) return false;
+        struct timespec timeout = { .tv_sec = remaining_ns / 1000000000L, .tv_nsec = remaining_ns % 1000000000L };
+        syscall(SYS_futex, &readers->ready, FUTEX_WAIT, ready, &timeout, NULL, 0);
+    }
+    return true;
+}
+
+unsigned int ext_read_begin(const GameExt* ext) {
+    unsigned int seq;
+    while ((seq = __atomic_load_n(&ext->seq, __ATOMIC_ACQUIRE)) & 1) {
+        sched_yield(); // el máster está escribiendo
+    }
+    return seq;
+}
+
+void ext_journal_append(GameExt* ext, const JournalEntry* entry) {
+    unsigned int seq = ext->journal_head + 1;
+    JournalEntry* slot = &ext->journal[seq & (JOURNAL_SIZE - 1)];
+
+    // Mismo esquema que el seqlock pero por registro: seq en 0 mientras se pisan los campos
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->from = entry->from;
+    slot->to = entry->to;
+    slot->score_delta = entry->score_delta;
+    slot->blocked = entry->blocked;
+    slot->player_id = entry->player_id;
+    __atomic_store_n(&slot->seq, seq, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&ext->journal_head, seq, __ATOMIC_RELEASE);
+}
+
+bool ext_journal_read(const GameExt* ext, unsigned int seq, JournalEntry* out) {
+    const JournalEntry* slot = &ext->journal[seq & (JOURNAL_SIZE - 1)];
+
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != seq) {
+        return false;
+    }
+    out->from = slot->from;
+    out->to = slot->to;
+    out->score_delta = slot->score_delta;
+    out->blocked = slot->blocked;
+    out->player_id = slot->player_id;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq) {
+        return false;
+    }
+    out->seq = seq;
+    return true;
+}
+
+void ext_publish(GameExt* ext) {
+    __atomic_add_fetch(&ext->generation, 1, __ATOMIC_SEQ_CST);
+    // Solo se paga la syscall si hay alguien durmiendo
+    if (__atomic_load_n(&readers->waiters, __ATOMIC_SEQ_CST) > 0) {
+        syscall(SYS_futex, &ext->generation, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+void ext_wait_generation(GameExt* ext, unsigned int seen, int timeout_ms) {
+    struct timespec timeout = { .tv_sec = timeout_ms / 1000, .tv_nsec = (timeout_ms % 1000) * 1000000L };
+
+    __atomic_add_fetch(&readers->waiters, 1, __ATOMIC_SEQ_CST);
+    // El kernel compara generation con `seen` atómicamente antes de dormir, si ya cambió vuelve enseguida
+    if (__atomic_load_n(&ext->generation, __ATOMIC_SEQ_CST) == seen) {
+        syscall(SYS_futex, &ext->generation, FUTEX_WAIT, seen, &timeout, NULL, 0);
+    }
+    __atomic_sub_fetch(&readers->waiters, 1, __ATOMIC_SEQ_CST);
+}
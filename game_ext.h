@@ -0,0 +1,224 @@
+// game_ext.h
+#ifndef GAME_EXT_H
+#define GAME_EXT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+// Extensiones del protocolo que no son parte del enunciado. Viven en un segmento aparte para no
+// tocar el layout de GameState ni de SyncState: si el segmento no existe (por ejemplo corriendo
+// con ChompChamps) la vista y los players usan el protocolo original.
+#define SHM_EXT "/game_ext"
+#define SHM_EXT_READERS "/game_ext_readers" // lo que escriben la vista y los players (ExtReaders)
+#define SHM_BUFFERS "/game_buffers" // copias publicadas del estado (--sync buffers)
+
+// Usuario con el que corren la vista y los players (el máster les hace setuid). /game_ext solo lo
+// escribe el máster (0644, los lectores lo mapean solo lectura); /game_ext_readers es de este usuario
+// con permisos 0600, así ningún otro usuario de la máquina puede tocar los contadores.
+#define EXT_READER_UID 1000
+
+#define EXT_SENDERS_MAX 9 // MAX_PLAYERS de game_state.h
+
+#define EXT_MAGIC 0x53315054 // "TP1S"
+
+// Namespace de la partida: si el máster corre con --ns, todos los segmentos y FIFOs llevan el sufijo
+// y se le pasa a la vista y los players por la variable de entorno GAME_NS. Sin namespace los nombres
+// son los del enunciado, así se puede seguir corriendo con ChompChamps.
+#define NS_ENV "GAME_NS"
+#define NS_MAX 32
+#define NS_NAME_MAX 96
+
+// Máster: fija el namespace (y lo exporta para los hijos). Devuelve false si tiene caracteres inválidos.
+bool ns_set(const char* ns);
+const char* ns_get();
+
+// Escribe en `out` el nombre de `base` dentro del namespace actual ("/game_state" -> "/game_state_ns")
+void ns_name(char* out, size_t size, const char* base);
+
+// Ruta del FIFO del jugador i dentro del namespace actual
+void ns_fifo_path(char* out, size_t size, int player);
+
+// Cómo se protege la lectura del estado
+typedef enum {
+    SYNC_LIGHTSWITCH = 0, // el del enunciado: starvation_mutex + lightswitch de lectores
+    SYNC_SEQLOCK = 1,     // el máster nunca espera a los lectores, ellos reintentan si leyeron a medias
+    SYNC_BUFFERED = 2,    // los lectores copian la última de varias copias publicadas, sin locks ni reintentos
+} SyncMode;
+
+// --sync buffers: además del estado del enunciado (que el máster sigue escribiendo en el lugar) hay
+// buffer_count copias en /game_buffers. Después de cada escritura el máster pone al día una copia que
+// nadie esté leyendo y la publica cambiando `front` con un store atómico. Los lectores anotan cuál
+// están copiando en buffer_readers, así el máster no la reescribe mientras tanto; la que está al frente
+// nunca se escribe, así que el lector siempre ve un estado completo que no cambia. El máster nunca
+// espera a los lectores: si todas las demás copias se están leyendo saltea esa publicación y la
+// reintenta más tarde. Hacen falta al menos 3 copias para que un lector lento (o uno que murió en
+// medio de una copia y la dejó tomada para siempre) no frene las publicaciones.
+#define EXT_BUFFERS_MIN 3
+#define EXT_BUFFERS_MAX 8
+#define EXT_BUFFERS_DEFAULT 3
+#define EXT_NO_BUFFER 0xFFFFFFFFu // ext_buffer_back: no hay ninguna copia libre
+
+// Cómo se mapea el segmento del estado (opciones --prefault y --hugepages del máster)
+#define EXT_PREFAULT 0x1  // cada proceso trae y fija (mlock) las páginas del estado antes de que arranque el juego
+#define EXT_HUGEPAGES 0x2 // el estado se pide con páginas grandes (THP sobre /dev/shm, madvise)
+
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+// Bitácora de movimientos: el máster agrega un registro por cada movimiento válido, así los lectores
+// pueden poner al día su copia del tablero aplicando solo lo que cambió. Es un buffer circular;
+// quien se atrasa más de JOURNAL_SIZE movimientos vuelve a copiar el tablero entero.
+#define JOURNAL_SIZE 1024 // potencia de 2
+
+typedef struct {
+    unsigned int seq;         // número de movimiento válido (desde 1), se escribe último; 0 = a medio escribir
+    unsigned int from;        // celda de la que salió el jugador (índice lineal)
+    unsigned int to;          // celda que pasó a ocupar
+    unsigned int score_delta; // lo que sumó (valor que tenía la celda `to`)
+    unsigned short blocked;   // bit i prendido si el jugador i quedó bloqueado después del movimiento
+    unsigned char player_id;
+} JournalEntry;
+
+typedef struct {
+    unsigned int magic;
+    pid_t master_pid;     // para no confundirse con un segmento viejo de otra partida
+    unsigned int sync_mode;
+    unsigned int cell_size; // sizeof(cell_t) con el que se compiló el máster
+    unsigned int map_flags; // EXT_PREFAULT | EXT_HUGEPAGES
+    unsigned int seq;     // seqlock: impar mientras el máster está escribiendo el estado
+    unsigned int generation;   // se incrementa cada vez que el máster publica un estado nuevo
+    unsigned int journal_head; // seq del último registro agregado (0 si todavía no hubo movimientos)
+    unsigned int version;      // versión del estado: el máster la incrementa dentro de cada escritura
+    unsigned int view_fps;     // --view-fps: la vista dibuja sola a esta frecuencia (0 = handshake por movimiento)
+    unsigned int buffer_count; // copias en /game_buffers (solo con SYNC_BUFFERED)
+    unsigned int front;        // copia publicada más reciente
+    unsigned int buffer_version[EXT_BUFFERS_MAX]; // `version` del estado que tiene cada buffer
+    unsigned int buffer_journal[EXT_BUFFERS_MAX]; // journal_head del estado que tiene cada buffer
+    JournalEntry journal[JOURNAL_SIZE];
+} GameExt;
+
+// Lo único que escriben los lectores, en /game_ext_readers. ext_create/ext_attach lo mapean junto con
+// /game_ext y las funciones de abajo lo usan solas.
+typedef struct {
+    unsigned int ready;   // lectores que ya prepararon su mapeo (solo con EXT_PREFAULT)
+    unsigned int waiters; // lectores dormidos esperando un cambio de generation (futex)
+    unsigned int buffer_readers[EXT_BUFFERS_MAX]; // lectores copiando cada buffer
+    pid_t move_senders[EXT_SENDERS_MAX]; // players que mandan MoveMessage (ext_enable_move_messages)
+} ExtReaders;
+
+// Movimientos con versión: un player que encuentra /game_ext, en lugar del byte de la dirección manda
+// un MoveMessage con la versión del estado con el que decidió (leída dentro de la sección de lectura).
+// Con eso el máster descarta, sin contarlos como inválidos, los movimientos que quedaron viejos (el
+// jugador ya se movió después de decidirlos) y el player puede reemplazar el que todavía no se aplicó.
+// El player lo avisa con ext_enable_move_messages antes de mandar el primero; de los que no lo avisan
+// el máster toma cada byte como una dirección, así los players del enunciado no cambian.
+#define MOVE_MSG_MARKER 0xA5 // primer byte del mensaje; no es una dirección válida
+
+#define MOVE_REPLACE 0x1 // reemplaza al último movimiento con versión que el jugador tenga encolado
+
+typedef struct {
+    unsigned char marker; // MOVE_MSG_MARKER
+    unsigned char dir;
+    unsigned char flags;  // MOVE_REPLACE
+    unsigned char reserved;
+    unsigned int version; // GameExt.version del estado leído
+} MoveMessage; // 8 bytes: se escribe en el FIFO con un solo write atómico (< PIPE_BUF)
+
+// Máster: crea los dos segmentos. El seqlock arranca impar, los lectores esperan hasta que empiece el juego.
+GameExt* ext_create(SyncMode mode, unsigned int cell_size, unsigned int map_flags);
+void ext_destroy(GameExt* ext);
+
+// Vista/players: mapean /game_ext solo lectura y /game_ext_readers. Devuelve NULL si no hay segmento
+// o si es de otro máster.
+// Si el máster usa otro tamaño de celda termina el proceso: no hay forma de leer el tablero.
+GameExt* ext_attach(unsigned int cell_size);
+
+// Player: anota su pid entre los que mandan MoveMessage. Hay que llamarlo antes del primer write.
+void ext_enable_move_messages(GameExt* ext);
+// Máster: si el proceso `pid` avisó que manda MoveMessage.
+bool ext_sends_move_messages(GameExt* ext, pid_t pid);
+void ext_detach(GameExt* ext);
+
+// Tamaño con el que hay que truncar y mapear el segmento del estado: con páginas grandes se redondea
+// a un múltiplo de HUGE_PAGE_SIZE. Todos los procesos tienen que mapear el mismo tamaño.
+size_t ext_state_map_size(size_t size, unsigned int map_flags);
+
+// Prepara un mapeo recién hecho según map_flags: pide páginas grandes y/o trae todas las páginas
+// a memoria (mlock si se puede, si no tocando una dirección por página). Sirve también para buffers
+// privados grandes. Es best effort: si el sistema no lo permite, el juego sigue con fallos de página.
+void ext_prepare_mapping(void* addr, size_t size, unsigned int map_flags);
+
+// Lectores: avisan que ya prepararon sus mapeos
+void ext_signal_ready(GameExt* ext);
+
+// Máster: espera hasta que `count` lectores avisen o pasen timeout_ms. Devuelve false si se venció.
+bool ext_wait_ready(GameExt* ext, unsigned int count, int timeout_ms);
+
+// Escritura del estado (solo el máster)
+static inline void ext_write_begin(GameExt* ext) {
+    __atomic_store_n(&ext->seq, ext->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void ext_write_end(GameExt* ext) {
+    __atomic_store_n(&ext->seq, ext->seq + 1, __ATOMIC_RELEASE);
+}
+
+// Lectura optimista: se copia lo necesario entre ext_read_begin y ext_read_retry,
+// y si ext_read_retry devuelve true la copia puede estar rota y hay que repetirla
+unsigned int ext_read_begin(const GameExt* ext);
+
+static inline bool ext_read_retry(const GameExt* ext, unsigned int seq) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&ext->seq, __ATOMIC_RELAXED) != seq;
+}
+
+// Máster: agrega un registro (entry->seq se ignora, se usa journal_head + 1)
+void ext_journal_append(GameExt* ext, const JournalEntry* entry);
+
+// Lectores: copia el registro número `seq`. Devuelve false si ya fue pisado (o se está pisando)
+// por uno más nuevo; en ese caso hay que copiar el tablero entero.
+bool ext_journal_read(const GameExt* ext, unsigned int seq, JournalEntry* out);
+
+// Máster: avisa que hay un estado nuevo y despierta a los que estén esperando
+void ext_publish(GameExt* ext);
+
+// Lectores: duerme hasta que generation sea distinta de `seen` o pasen timeout_ms.
+// `seen` tiene que leerse antes de copiar el estado, así no se pierde una publicación intermedia.
+void ext_wait_generation(GameExt* ext, unsigned int seen, int timeout_ms);
+
+// Tamaño de cada copia en /game_buffers para un estado de state_size bytes (alineado a línea de caché)
+size_t ext_buffer_stride(size_t state_size);
+
+// Máster: crea /game_buffers con buffer_count copias de stride bytes; lectores: lo mapean solo lectura.
+// Devuelven NULL si no se pudo.
+void* ext_buffers_create(GameExt* ext, size_t stride);
+void* ext_buffers_attach(const GameExt* ext, size_t stride);
+void ext_buffers_destroy(void* buffers, const GameExt* ext, size_t stride);
+void ext_buffers_detach(void* buffers, const GameExt* ext, size_t stride);
+
+static inline void* ext_buffer(void* buffers, size_t stride, unsigned int index) {
+    return (char*)buffers + stride * index;
+}
+
+// Lectores: toman el buffer publicado (no cambia hasta ext_buffer_release). En `retries` suman las veces
+// que el máster lo cambió justo mientras lo tomaban.
+unsigned int ext_buffer_acquire(GameExt* ext, unsigned int* retries);
+void ext_buffer_release(GameExt* ext, unsigned int index);
+
+// Máster: un buffer que no esté al frente ni lo esté copiando nadie, o EXT_NO_BUFFER si están todos
+// tomados (no espera a que se libere uno).
+unsigned int ext_buffer_back(GameExt* ext);
+// Máster: publica el buffer (ya escrito entero, con buffer_version y buffer_journal)
+void ext_buffer_flip(GameExt* ext, unsigned int index);
+
+// Lectores: versión del estado, se lee dentro de la sección de lectura junto con el resto de la copia
+static inline unsigned int ext_version(const GameExt* ext) {
+    return __atomic_load_n(&ext->version, __ATOMIC_RELAXED);
+}
+
+static inline unsigned int ext_generation(const GameExt* ext) {
+    return __atomic_load_n(&ext->generation, __ATOMIC_ACQUIRE);
+}
+
+#endif // GAME_EXT_H
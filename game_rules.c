@@ -0,0 +1,383 @@
+// game_rules.c
+#define _POSIX_C_SOURCE 200112L // sysconf
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <math.h> // Para usar sin() y cos()
+#include <stdlib.h>
+#include <string.h>
+
+#include "game_rules.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define FILL_PARALLEL_MIN (1 << 18) // celdas a partir de las que conviene repartir el llenado
+#define FILL_THREADS_MAX 16
+
+typedef struct {
+    cell_t* board;
+    unsigned int seed;
+    size_t from;
+    size_t to;
+} FillRange;
+
+static void* fill_range(void* arg) {
+    FillRange* range = arg;
+    for (size_t i = range->from; i < range->to; i++) {
+        range->board[i] = board_counter_value(range->seed, (uint32_t)i);
+    }
+    return NULL;
+}
+
+void fill_board(cell_t* board, unsigned short width, unsigned short height, unsigned int seed, BoardGenerator generator,
+                bool parallel) {
+    size_t cells = (size_t)width * height;
+    if (generator == BOARD_RAND) {
+        srand(seed);
+        for (size_t i = 0; i < cells; i++) {
+            board[i] = (rand() % 9) + 1; // Valores aleatorios entre 1 y 9
+        }
+        return;
+    }
+
+    // Cada celda depende solo de su índice: se reparte en tramos contiguos, uno por núcleo
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads = !parallel || cells < FILL_PARALLEL_MIN || cores < 1 ? 1 : (cores > FILL_THREADS_MAX ? FILL_THREADS_MAX : cores);
+    FillRange ranges[FILL_THREADS_MAX];
+    pthread_t ids[FILL_THREADS_MAX];
+    bool started[FILL_THREADS_MAX] = { false };
+    for (int t = 0; t < threads; t++) {
+        ranges[t] = (FillRange){ board, seed, cells * t / threads, cells * (t + 1) / threads };
+        // El tramo 0 lo hace este hilo; si no se puede crear un hilo, su tramo también
+        started[t] = t > 0 && pthread_create(&ids[t], NULL, fill_range, &ranges[t]) == 0;
+    }
+    for (int t = 0; t < threads; t++) {
+        if (!started[t]) fill_range(&ranges[t]);
+    }
+    for (int t = 1; t < threads; t++) {
+        if (started[t]) pthread_join(ids[t], NULL);
+    }
+}
+
+static void init_state(GameState* state, unsigned short width, unsigned short height, unsigned int seed,
+                       BoardGenerator generator, bool parallel, unsigned int player_count, char* const player_paths[]) {
+    state->width = width;
+    state->height = height;
+    state->player_count = player_count;
+    state->is_finished = false;
+
+    // Inicializar el tablero
+    fill_board(state->board, width, height, seed, generator, parallel);
+
+    // Calcular el centro de la elipse
+    int center_x = width / 2;
+    int center_y = height / 2;
+
+    // Calcular los semiejes de la elipse
+    double semi_major_axis = width * 0.3;  // Eje mayor (30% del ancho del tablero)
+    double semi_minor_axis = height * 0.3; // Eje menor (30% del alto del tablero)
+
+    // if (player_count >= 5) {
+    //     semi_major_axis = width * 0.4;  // Eje mayor (40% del ancho del tablero)
+    //     semi_minor_axis = height * 0.4; // Eje menor (40% del alto del tablero)
+    // }
+
+    // Inicializar jugadores
+    for (int i = 0; i < player_count; i++) {
+        state->players[i].score = 0;
+        state->players[i].invalid_moves = 0;
+        state->players[i].valid_moves = 0;
+        state->players[i].is_blocked = false;
+        state->players[i].pid = -1;
+
+        // Obtener el nombre del jugador
+        if (player_paths == NULL) {
+            state->players[i].name[0] = '\0';
+        } else {
+            char* last_slash = strrchr(player_paths[i], '/');
+            if (last_slash != NULL) {
+                strncpy(state->players[i].name, last_slash + 1, MAX_NAME - 1);
+            } else {
+                strncpy(state->players[i].name, player_paths[i], MAX_NAME - 1);
+            }
+            state->players[i].name[MAX_NAME - 1] = '\0'; // Asegurarse de que la cadena esté terminada
+        }
+
+        // Calcular la posición del jugador en la elipse
+        double angle = (2 * M_PI / player_count) * i; // Ángulo en radianes
+        int x = center_x + (int)(semi_major_axis * cos(angle));
+        int y = center_y + (int)(semi_minor_axis * sin(angle));
+
+        // Asegurarse de que las posiciones estén dentro de los límites del tablero
+        x = (x < 0) ? 0 : (x >= width ? width - 1 : x);
+        y = (y < 0) ? 0 : (y >= height ? height - 1 : y);
+
+        state->players[i].x = x;
+        state->players[i].y = y;
+
+        if (player_count == 1) {
+            // Si solo hay un jugador, va al centro, como ChompChamps
+            state->players[i].x = center_x;
+            state->players[i].y = center_y;
+        }
+
+        // Marcar la celda como ocupada por el jugador
+        state->board[state->players[i].y * width + state->players[i].x] = -i;
+    }
+}
+
+void init_game_state(GameState* state, unsigned short width, unsigned short height, unsigned int seed,
+                     BoardGenerator generator, unsigned int player_count, char* const player_paths[]) {
+    init_state(state, width, height, seed, generator, true, player_count, player_paths);
+}
+
+
+void modify_x_y_acording_to_dir(unsigned char dir, int* x, int* y) {
+    if (dir >= DIRECTIONS) return;
+    *x += dx[dir];
+    *y += dy[dir];
+}
+
+bool validate_move(unsigned char dir, const GameState* state, int my_id) {
+    return can_move_to(state->board, state->width, state->height,
+                       state->players[my_id].x, state->players[my_id].y, dir);
+}
+
+// Actualiza los contadores de los 8 vecinos de una celda que acaba de ocuparse (índice con borde)
+static void occupy_cell(RulesGame* game, int index) {
+    for (unsigned char dir = 0; dir < DIRECTIONS; dir++) {
+        game->free_neighbours[index + game->board.offsets[dir]]--;
+    }
+}
+
+// Marca como bloqueado al jugador si está parado en la celda (índice con borde) y ya no tiene vecinos
+// libres. Las celdas del borde valen 0 como las del jugador 0, pero nunca son su posición.
+static void update_blocked_at(RulesGame* game, int index) {
+    int cell = game->board.cells[index];
+    if (cell > 0) return; // celda libre, no hay nadie
+
+    Player* player = &game->state->players[-cell];
+    if (!player->is_blocked && padded_index(&game->board, player->x, player->y) == index &&
+        game->free_neighbours[index] == 0) {
+        player->is_blocked = true;
+        game->unblocked_players--;
+    }
+}
+
+// Copia el tablero, cuenta los vecinos libres de todas las celdas y marca a los jugadores que están sin salida
+void rules_recount(RulesGame* game) {
+    GameState* state = game->state;
+    PaddedBoard* board = &game->board;
+    padded_load(board, state->board);
+    for (int y = 0; y < state->height; y++) {
+        int index = padded_index(board, 0, y);
+        for (int x = 0; x < state->width; x++, index++) {
+            unsigned char count = 0;
+            for (unsigned char dir = 0; dir < DIRECTIONS; dir++) {
+                count += board->cells[index + board->offsets[dir]] > 0;
+            }
+            game->free_neighbours[index] = count;
+        }
+    }
+
+    // Los que ya estaban bloqueados (un estado restaurado a mitad de partida) no se vuelven a contar
+    game->unblocked_players = 0;
+    for (int i = 0; i < state->player_count; i++) {
+        if (!state->players[i].is_blocked) game->unblocked_players++;
+    }
+    for (int i = 0; i < state->player_count; i++) {
+        update_blocked_at(game, padded_index(board, state->players[i].x, state->players[i].y));
+    }
+}
+
+bool rules_attach(RulesGame* game, GameState* state) {
+    game->state = state;
+    game->owns_counters = true;
+    game->free_neighbours = calloc(padded_cell_count(state->width, state->height), 1);
+    bool board_ok = padded_init(&game->board, state->width, state->height);
+    if (!board_ok || game->free_neighbours == NULL) {
+        // Lo que sí se pidió se libera acá: quien recibe false no llama a rules_detach
+        padded_free(&game->board);
+        free(game->free_neighbours);
+        game->free_neighbours = NULL;
+        return false;
+    }
+    rules_recount(game);
+    return true;
+}
+
+void rules_detach(RulesGame* game) {
+    if (game->owns_counters) {
+        padded_free(&game->board);
+        free(game->free_neighbours);
+    }
+    game->free_neighbours = NULL;
+    game->state = NULL;
+}
+
+// El estado va primero; la copia con borde y los contadores, a continuación, alineados a 8
+static size_t align8(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+static size_t state_size(unsigned short width, unsigned short height) {
+    return align8(sizeof(GameState) + sizeof(cell_t) * width * height);
+}
+
+static size_t padded_size(unsigned short width, unsigned short height) {
+    return align8(sizeof(cell_t) * padded_cell_count(width, height));
+}
+
+size_t rules_game_size(unsigned short width, unsigned short height) {
+    return state_size(width, height) + padded_size(width, height) + padded_cell_count(width, height);
+}
+
+void rules_game_init(RulesGame* game, void* memory, unsigned short width, unsigned short height, unsigned int seed,
+                     BoardGenerator generator, unsigned int player_count, char* const player_paths[]) {
+    char* bytes = memory;
+    game->state = memory;
+    padded_attach(&game->board, (cell_t*)(bytes + state_size(width, height)), width, height);
+    game->free_neighbours = (unsigned char*)(bytes + state_size(width, height) + padded_size(width, height));
+    game->owns_counters = false;
+    // En lote se arman miles de partidas seguidas: nada de crear hilos por cada tablero
+    init_state(game->state, width, height, seed, generator, false, player_count, player_paths);
+    rules_recount(game);
+}
+
+
+// Mueve al jugador a la nueva posición y actualiza el puntaje
+// y el tablero
+void move_player(RulesGame* game, int player_id, unsigned char dir) {
+    GameState* state = game->state;
+    cell_t* board = state->board;
+    int width = state->width;
+
+    // Obtener la posición actual del jugador
+    int my_x = state->players[player_id].x;
+    int my_y = state->players[player_id].y;
+
+    // Calcular nueva posición según la dirección
+    modify_x_y_acording_to_dir(dir, &my_x, &my_y);
+
+    // Actualizar la posición del jugador
+    state->players[player_id].x = my_x;
+    state->players[player_id].y = my_y;
+    state->players[player_id].score += board[my_y * width + my_x]; // Sumar el valor de la celda al puntaje
+
+    // Actualizar el tablero (y la copia con borde)
+    board[my_y * width + my_x] = -player_id; // Marcar la celda como ocupada por el jugador
+    int index = padded_index(&game->board, my_x, my_y);
+    game->board.cells[index] = -player_id;
+    occupy_cell(game, index);
+}
+
+
+// Intenta mover al jugador en la dirección especificada. Devuelve true si el movimiento fue válido.
+bool try_to_move_player(RulesGame* game, int player_id, unsigned char dir) {
+    GameState* state = game->state;
+    Player* player = &state->players[player_id];
+    if (padded_can_move(&game->board, padded_index(&game->board, player->x, player->y), dir)) {
+        move_player(game, player_id, dir);
+        state->players[player_id].valid_moves++;
+        return true;
+    } else {
+        state->players[player_id].invalid_moves++;
+        return false;
+    }
+}
+
+// Verifica si todos los jugadores están bloqueados después de que se ocupó la celda (x, y).
+// Solo pueden haber quedado bloqueados el que se movió y los que están alrededor de esa celda.
+bool check_for_blocking(RulesGame* game, int x, int y) {
+    int index = padded_index(&game->board, x, y);
+    update_blocked_at(game, index);
+    for (unsigned char dir = 0; dir < DIRECTIONS; dir++) {
+        update_blocked_at(game, index + game->board.offsets[dir]);
+    }
+    return game->unblocked_players == 0;
+}
+
+bool play_move(RulesGame* game, int player_id, unsigned char dir) {
+    Player* player = &game->state->players[player_id];
+    bool moved = try_to_move_player(game, player_id, dir);
+    if (moved) {
+        game->state->is_finished = check_for_blocking(game, player->x, player->y);
+    }
+    return moved;
+}
+
+unsigned short blocked_mask(const GameState* state) {
+    unsigned short mask = 0;
+    for (int i = 0; i < state->player_count; i++) {
+        if (state->players[i].is_blocked) mask |= 1 << i;
+    }
+    return mask;
+}
+
+void determine_winner(const GameState* state, bool winners[]) {
+    int best_player = -1;
+    unsigned int best_score = 0;
+    unsigned int best_valid_moves = UINT_MAX;
+    unsigned int best_invalid_moves = UINT_MAX;
+
+    // Initialize the winners array
+    for (int i = 0; i < state->player_count; i++) {
+        winners[i] = false;
+    }
+
+    // Determine the best player based on the criteria
+    for (int i = 0; i < state->player_count; i++) {
+        const Player* player = &state->players[i];
+
+        if (player->score > best_score ||
+            (player->score == best_score && player->valid_moves < best_valid_moves) ||
+            (player->score == best_score && player->valid_moves == best_valid_moves && player->invalid_moves < best_invalid_moves)) {
+            best_score = player->score;
+            best_valid_moves = player->valid_moves;
+            best_invalid_moves = player->invalid_moves;
+            best_player = i;
+        }
+    }
+
+    // Mark the winner or winners in case of a tie
+    if (best_player != -1) {
+        for (int i = 0; i < state->player_count; i++) {
+            const Player* player = &state->players[i];
+            if (player->score == best_score &&
+                player->valid_moves == best_valid_moves &&
+                player->invalid_moves == best_invalid_moves) {
+                winners[i] = true;
+            }
+        }
+    }
+}
+
+void simulate_games(void* memory, unsigned short width, unsigned short height, unsigned int player_count,
+                    unsigned int first_seed, BoardGenerator generator, size_t game_count, unsigned int max_moves,
+                    MovePolicy policy, void* arg, SimResult results[]) {
+    RulesGame game;
+    for (size_t g = 0; g < game_count; g++) {
+        SimResult* result = &results[g];
+        result->seed = first_seed + g;
+        rules_game_init(&game, memory, width, height, result->seed, generator, player_count, NULL);
+
+        GameState* state = game.state;
+        unsigned int moves = 0;
+        while (!state->is_finished && game.unblocked_players > 0 && moves < max_moves) {
+            for (unsigned int i = 0; i < player_count && !state->is_finished && moves < max_moves; i++) {
+                if (state->players[i].is_blocked) continue;
+                play_move(&game, i, policy(state, i, arg));
+                moves++;
+            }
+        }
+
+        result->moves = moves;
+        result->finished = game.unblocked_players == 0;
+        for (unsigned int i = 0; i < player_count; i++) {
+            result->scores[i] = state->players[i].score;
+        }
+        determine_winner(state, result->winners);
+    }
+}
@@ -0,0 +1,123 @@
+// game_rules.h
+#ifndef GAME_RULES_H
+#define GAME_RULES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game_state.h"
+#include "padded_board.h" // DIRECTIONS, dx, dy
+
+// Reglas del juego: armado del tablero y de los jugadores, validación y aplicación de movimientos,
+// detección de bloqueos y ganador. Es la única copia de las reglas: la usan el máster, la vista, los
+// players y las herramientas que rearman o simulan partidas sin correrlas (replay, simulate), así el
+// resultado es exactamente el mismo que en una partida real.
+
+// true si desde (x, y) se puede ir en la dirección dir: cae dentro del tablero y en una celda libre
+static inline bool can_move_to(const cell_t* board, int width, int height, int x, int y, unsigned char dir) {
+    if (dir >= DIRECTIONS) return false;
+    int nx = x + dx[dir];
+    int ny = y + dy[dir];
+    return nx >= 0 && nx < width && ny >= 0 && ny < height && board[ny * width + nx] > 0;
+}
+
+// Una partida en curso: el estado (compartido o no), una copia del tablero con borde para validar sin
+// chequear límites y los contadores de vecinos libres de cada celda, que permiten detectar bloqueos
+// en O(1) después de cada movimiento. Los contadores usan los índices del tablero con borde; los del
+// borde no significan nada, solo absorben los decrementos de sus vecinos.
+typedef struct {
+    GameState* state;
+    PaddedBoard board;
+    unsigned char* free_neighbours;
+    unsigned int unblocked_players;
+    bool owns_counters; // board y free_neighbours se pidieron en rules_attach
+} RulesGame;
+
+// Cómo se generan los valores del tablero a partir de la semilla
+typedef enum {
+    BOARD_RAND = 0,    // srand(seed) y rand() % 9 + 1 celda por celda, como ChompChamps (depende de la libc)
+    BOARD_COUNTER = 1, // board_counter_value(seed, i): igual en cualquier plataforma y se llena en paralelo
+} BoardGenerator;
+
+// Valor de la celda i (y * width + x) con BOARD_COUNTER: la primera salida de splitmix64 con estado
+// (seed << 32 | i), llevada a 1..9 con multiplicación y corrimiento. Solo depende de (seed, i), así que
+// cualquiera puede calcular una celda sin generar las anteriores.
+static inline cell_t board_counter_value(uint32_t seed, uint32_t index) {
+    uint64_t z = ((uint64_t)seed << 32 | index) + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (cell_t)(((z >> 32) * 9) >> 32) + 1;
+}
+
+// Llena el tablero con la semilla. Con BOARD_COUNTER, `parallel` y un tablero grande lo reparten varios
+// hilos; el resultado es el mismo con cualquier cantidad de hilos.
+void fill_board(cell_t* board, unsigned short width, unsigned short height, unsigned int seed, BoardGenerator generator,
+                bool parallel);
+
+// Arma el tablero con la semilla (fill_board) y ubica a los jugadores en una elipse. Los nombres salen
+// de la última parte de cada ruta; con player_paths en NULL quedan vacíos.
+void init_game_state(GameState* state, unsigned short width, unsigned short height, unsigned int seed,
+                     BoardGenerator generator, unsigned int player_count, char* const player_paths[]);
+
+// Toma un estado ya armado (init_game_state, o una copia restaurada a mitad de partida), copia el
+// tablero y calcula los contadores. Devuelve false si no hubo memoria. rules_detach los libera.
+bool rules_attach(RulesGame* game, GameState* state);
+void rules_detach(RulesGame* game);
+// Vuelve a copiar el tablero y calcular los contadores después de pisar el estado entero (por ejemplo
+// con una copia). Si solo cambia a dónde apunta `state`, con el mismo contenido, no hace falta.
+void rules_recount(RulesGame* game);
+
+// Partidas sin memoria dinámica: rules_game_size bytes alcanzan para el estado, la copia con borde y
+// los contadores de un tablero de width x height, y rules_game_init arma ahí la partida de la semilla dada.
+// El tablero se llena en el hilo que llama, sin crear hilos aunque sea grande.
+size_t rules_game_size(unsigned short width, unsigned short height);
+void rules_game_init(RulesGame* game, void* memory, unsigned short width, unsigned short height, unsigned int seed,
+                     BoardGenerator generator, unsigned int player_count, char* const player_paths[]);
+
+// Corre (x, y) un paso en la dirección dir
+void modify_x_y_acording_to_dir(unsigned char dir, int* x, int* y);
+
+bool validate_move(unsigned char dir, const GameState* state, int my_id);
+
+void move_player(RulesGame* game, int player_id, unsigned char dir);
+
+// Intenta mover al jugador en la dirección especificada. Devuelve true si el movimiento fue válido.
+bool try_to_move_player(RulesGame* game, int player_id, unsigned char dir);
+
+// Después de ocupar (x, y): marca a los que quedaron bloqueados y devuelve true si ya no queda nadie
+bool check_for_blocking(RulesGame* game, int x, int y);
+
+// Un movimiento completo como lo aplica el máster: lo valida, lo aplica y si nadie puede moverse
+// termina la partida (is_finished). Devuelve true si fue válido.
+bool play_move(RulesGame* game, int player_id, unsigned char dir);
+
+// Máscara con el bit i prendido si el jugador i está bloqueado
+unsigned short blocked_mask(const GameState* state);
+
+// winners[i] queda en true para el ganador: más puntaje, y a igual puntaje menos movimientos válidos
+// y después menos inválidos. Si empatan en todo ganan todos los empatados.
+void determine_winner(const GameState* state, bool winners[]);
+
+// Simulación en lote: muchas partidas independientes una atrás de otra sobre la misma memoria
+// (rules_game_size bytes), sin pedir memoria ni tocar memoria compartida. En cada vuelta juegan por
+// turno los jugadores no bloqueados, en orden de id, lo que la política elija; una dirección inválida
+// cuenta como movimiento inválido, igual que en el máster. Cada partida termina cuando nadie puede
+// moverse o a los max_moves movimientos (lo que en el máster sería el timeout).
+typedef unsigned char (*MovePolicy)(const GameState* state, int player_id, void* arg);
+
+typedef struct {
+    unsigned int seed;
+    unsigned int moves;
+    bool finished; // terminó porque todos quedaron bloqueados
+    unsigned int scores[MAX_PLAYERS];
+    bool winners[MAX_PLAYERS];
+} SimResult;
+
+// Juega game_count partidas con las semillas first_seed, first_seed + 1, ... y deja cada resultado en results
+void simulate_games(void* memory, unsigned short width, unsigned short height, unsigned int player_count,
+                    unsigned int first_seed, BoardGenerator generator, size_t game_count, unsigned int max_moves,
+                    MovePolicy policy, void* arg, SimResult results[]);
+
+#endif // GAME_RULES_H
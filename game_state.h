@@ -8,7 +8,18 @@
 
 #define MAX_PLAYERS 9
 #define MAX_NAME 16
-#define BOARD_MAX 100
+
+// Celdas del tablero: valores 1 a 9 si están libres, -id del jugador si están ocupadas.
+// El enunciado usa un int por celda; compilando con COMPACT_CELLS (make COMPACT=1) los tres binarios
+// usan un byte por celda, lo que hace entrar tableros mucho más grandes en memoria compartida.
+// Máster, vista y players tienen que compilarse igual (el máster lo publica en /game_ext).
+#ifdef COMPACT_CELLS
+typedef signed char cell_t;
+#else
+typedef int cell_t;
+#endif
+
+#define BOARD_MAX 4096
 
 #define SHM_STATE "/game_state"
 #define SHM_SYNC "/game_sync"
@@ -32,7 +43,7 @@ typedef struct {
     unsigned int player_count;
     Player players[MAX_PLAYERS];
     bool is_finished;
-    int board[]; // row 0, row 1, ..., row n-1
+    cell_t board[]; // row 0, row 1, ..., row n-1
 } GameState;
 
 // Estructura de sincronización
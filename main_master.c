@@ -6,21 +6,23 @@
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <sys/stat.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 
 #include <unistd.h>
+#include <errno.h>
 #include <semaphore.h>
 #include <wait.h>
 
 #include <stdbool.h>
 #include <time.h>
 #include <string.h>
-#include <math.h> // Para usar sin() y cos()
 #include "game_state.h"
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+#include "game_ext.h"
+#include "game_rules.h"
+#include "bench.h"
+#include "plugin.h"
+#include "record.h"
+#include "telemetry.h"
 
 #define SHM_STATE "/game_state"
 #define SHM_SYNC "/game_sync"
@@ -28,8 +30,8 @@
 #define WIDTH_MIN 10
 #define HEIGHT_MIN 10
 
-#define WIDTH_MAX 100
-#define HEIGHT_MAX 100
+#define WIDTH_MAX BOARD_MAX
+#define HEIGHT_MAX BOARD_MAX
 
 #define MAX_PLAYERS 9
 #define MAX_NAME 16
@@ -64,18 +66,73 @@ unsigned int player_count;
 char* view = NULL;
 int view_pid = -1;
 char* player_paths[MAX_PLAYERS] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+SyncMode sync_mode = SYNC_LIGHTSWITCH;
+unsigned int map_flags = 0; // EXT_PREFAULT | EXT_HUGEPAGES
+
+// Modo benchmark: corre bench_games partidas seguidas sin vista (semillas seed, seed + 1, ...)
+int bench_games = 0;
+char* bench_out = NULL;
+BenchFormat bench_format = BENCH_JSON;
 
 unsigned int player_count = 0;
 
 int last_player_moved = 0;  // índice, no pid
 
+bool tick_mode = false;    // --tick
+unsigned int tick = 0;     // ticks jugados en la partida, decide quién tiene prioridad en el siguiente
+
+unsigned int buffer_count = EXT_BUFFERS_DEFAULT; // --buffers (con --sync buffers)
+void* buffers = NULL;           // /game_buffers de la partida en curso
+size_t buffer_stride = 0;
+bool buffer_loaded[EXT_BUFFERS_MAX]; // el buffer ya tiene un tablero entero (después alcanza con la bitácora)
+bool buffer_behind = false; // la última publicación se salteó porque no había copia libre
+#define BUFFER_RETRY_MS 1 // cada cuánto se reintenta una publicación salteada si no llega ningún movimiento
+
+unsigned int view_fps = 0; // --view-fps, 0 = la vista dibuja cada movimiento (handshake del enunciado)
+
+BoardGenerator board_generator = BOARD_RAND; // --rng
+
+unsigned int max_stale = 0;       // --max-stale, 0 = sin límite de antigüedad
+unsigned int discarded_moves = 0; // movimientos con versión descartados en la partida (viejos o reemplazados)
+
+typedef struct {
+    int player_id;
+    unsigned char dir;
+} PendingMove;
+
+#define PENDING_MAX 64 // movimientos leídos del pipe que se pueden encolar por jugador
+
+#define NO_VERSION 0xFFFFFFFFu // movimiento que llegó como byte suelto (o de un plugin): nunca se descarta
+
+typedef struct {
+    unsigned char dir;
+    unsigned int version; // versión del estado con la que lo decidió el jugador (MoveMessage)
+} QueuedMove;
+
 typedef struct {
     pid_t pid;
     int pipe_read_fd;  // máster lee de acá
     bool active; // 1 si el jugador está activo, 0 si se cerró el pipe (ocurrió un EOF)
+    QueuedMove pending[PENDING_MAX]; // movimientos leídos que todavía no se aplicaron (cola circular)
+    int pending_head;
+    int pending_count;
+    unsigned char partial[sizeof(MoveMessage)]; // MoveMessage que quedó cortado entre dos read
+    int partial_len;
+    bool versioned; // avisó que manda MoveMessage (ext_enable_move_messages); si no, cada byte es una dirección
+    unsigned int moved_version; // versión del estado que dejó su último movimiento válido
+    PluginPlayer* plugin; // NULL si es un proceso; si no, pipe_read_fd es el eventfd del plugin
 } PlayerProc;
 
 PlayerProc processes[MAX_PLAYERS];
+int plugin_count = 0; // jugadores que corren como hilos del máster (-p algo.so)
+
+char* record_path = NULL; // --record: archivo donde grabar la partida
+
+bool telemetry_enabled = false; // --telemetry
+Telemetry* telemetry = NULL;    // segmento de la partida en curso, NULL sin --telemetry
+
+// Los pipes de los jugadores se registran una sola vez acá, en lugar de armar un fd_set por iteración
+int epoll_fd = -1;
 
 
 struct timeval last_msg_time;
@@ -84,13 +141,13 @@ void update_last_msg_time() {
     gettimeofday(&last_msg_time, NULL);
 }
 
-int get_remaining_timeout_sec(int total_timeout_sec) {
+int get_remaining_timeout_ms(int total_timeout_sec) {
     struct timeval now;
     gettimeofday(&now, NULL);
     
-    int elapsed = now.tv_sec - last_msg_time.tv_sec;
-    int remaining = total_timeout_sec - elapsed;
-    return remaining > 0 ? remaining : 0;
+    long elapsed = (now.tv_sec - last_msg_time.tv_sec) * 1000L + (now.tv_usec - last_msg_time.tv_usec) / 1000;
+    long remaining = total_timeout_sec * 1000L - elapsed;
+    return remaining > 0 ? (int)remaining : 0;
 }
 
 
@@ -105,11 +162,63 @@ corchetes son opcionales y tienen un valor por defecto.
 [-s seed]: Semilla utilizada para la generación del tablero. Default: time(NULL)
 [-v view]: Ruta del binario de la vista. Default: Sin vista.
 -p player1 player2: Ruta/s de los binarios de los jugadores. Mínimo: 1, Máximo: 9.
+    Extensión: una ruta que termina en .so se carga como plugin (ver player_plugin.h) y el jugador
+    corre en un hilo del máster en lugar de en un proceso aparte. Se pueden mezclar ambos tipos.
+
+Extensiones (no son parte del enunciado):
+[--sync lightswitch|seqlock|buffers]: Cómo leen el estado los players. Default: lightswitch.
+    Con seqlock el máster nunca espera a los lectores: incrementa un contador de versión antes
+    y después de escribir, y los lectores reintentan la copia si el contador cambió.
+    Con buffers el máster, después de escribir, pone al día una de varias copias del estado que
+    nadie esté leyendo y la publica con un cambio atómico de índice; los players copian la publicada
+    sin tomar ningún lock y sin reintentar (ver SYNC_BUFFERED en game_ext.h).
+[--buffers n]: Cantidad de copias con --sync buffers, entre 3 y 8. Default: 3. Si todas las copias
+    salvo la publicada se están leyendo, el máster no espera: saltea esa publicación y la reintenta.
+    Con 3 o más un lector que se quedó con una copia (lento o muerto a mitad) no frena al máster.
+[--bench games]: Corre esa cantidad de partidas seguidas sin vista, con semillas seed, seed + 1, ...
+    y en lugar de los puntajes imprime un reporte de rendimiento (tiempos, movimientos por segundo,
+    percentiles de latencia publicación -> movimiento y de la sección crítica).
+[--bench-out file]: Archivo donde escribir el reporte. Default: salida estándar.
+[--bench-format json|csv]: Formato del reporte. Default: json.
+[--ns id|auto]: Namespace de la partida: los segmentos y FIFOs llevan el sufijo id (auto usa el pid del
+    máster) y la vista y los players lo reciben en la variable de entorno GAME_NS. Permite correr varias
+    partidas a la vez en la misma máquina. Default: sin namespace (nombres del enunciado).
+[--prefault]: El máster, la vista y los players traen a memoria y fijan (mlock) todas las páginas del
+    estado antes de que arranque el juego; el máster espera a que todos avisen (como mucho el timeout)
+    antes de publicar el estado inicial, así los fallos de página no caen en los primeros movimientos.
+[--hugepages]: Pide páginas grandes para el segmento del estado (madvise sobre /dev/shm; hace falta que
+    /sys/kernel/mm/transparent_hugepage/shmem_enabled esté en advise). El tamaño se redondea a 2 MB.
+[--record file]: Graba la partida en file (semilla, dimensiones y un registro por movimiento, ver record.h)
+    para reproducirla después con replay. En modo benchmark cada partida va a file.<semilla>.
+[--telemetry]: Publica contadores e histogramas de latencia en /game_telemetry (espera por los semáforos,
+    secciones críticas, tiempo de dibujo de la vista y tiempo de reacción de cada jugador) que el
+    máster, la vista y los players actualizan durante la partida. `stats` los muestra en vivo.
+[--tick]: En lugar de un movimiento por vez, en cada tick se toma a lo sumo un movimiento pendiente de
+    cada jugador y se aplican todos juntos con una sola toma del mutex y un solo aviso a la vista (y un
+    solo delay). Si dos jugadores van a la misma celda la gana el primero en el orden del tick, que
+    rota: en el tick t empieza el jugador t % cantidad de jugadores.
+[--view-fps fps]: La vista no se sincroniza con el máster: cada 1/fps segundos copia el último estado
+    completo (con el contador del seqlock, sin tomar ningún semáforo) y lo dibuja, salteando los
+    intermedios. El máster no la espera ni hace el delay, así tener la vista abierta no le cuesta nada.
+    Se ignora -d. Una vista que no lee view_fps de /game_ext (la de la cátedra) recibe un único aviso
+    al terminar la partida y solo dibuja el estado final.
+[--max-stale n]: Descarta los movimientos con versión (ver MoveMessage en game_ext.h) decididos sobre
+    un estado más de n versiones anterior al actual. Default: sin límite; igual se descartan siempre
+    los decididos antes del último movimiento válido del jugador, que ya no salen de su posición.
+[--rng rand|counter]: Cómo se genera el tablero a partir de la semilla. Default: rand (srand/rand, el
+    mismo tablero que ChompChamps con esta libc). Con counter cada celda es una función de (seed, índice)
+    (board_counter_value en game_rules.h): el tablero es el mismo en cualquier plataforma y en los
+    tableros grandes lo llenan varios hilos. Queda anotado en la grabación para que replay lo rearme.
+
+Los players que encuentran /game_ext mandan cada movimiento con la versión del estado que leyeron y
+pueden reemplazar el que todavía tengan encolado (antes de mandar el primero se anotan en
+/game_ext_readers). Lo que se descarta no se aplica ni cuenta como inválido. De los players que no
+se anotaron cada byte del FIFO es una dirección, como en el enunciado.
 
 */
 void validate_args(int argc, char* argv[]) {
     if (argc < 2) {
-        fprintf(stderr, "Uso: %s [-w width] [-h height] [-d delay] [-t timeout] [-s seed] [-v view] [-p player1 player2 ...]\n", argv[0]);
+        fprintf(stderr, "Uso: %s [-w width] [-h height] [-d delay] [-t timeout] [-s seed] [-v view] [--sync lightswitch|seqlock|buffers] [--buffers n] [--bench games [--bench-out file] [--bench-format json|csv]] [--ns id|auto] [--prefault] [--hugepages] [--record file] [--telemetry] [--tick] [--view-fps fps] [--max-stale n] [--rng rand|counter] [-p player1 player2 ...]\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
@@ -134,6 +243,89 @@ void validate_args(int argc, char* argv[]) {
             seed = atoi(argv[++i]);
         } else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc) {
             view = argv[++i];
+        } else if (strcmp(argv[i], "--sync") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "lightswitch") == 0) {
+                sync_mode = SYNC_LIGHTSWITCH;
+            } else if (strcmp(argv[i], "seqlock") == 0) {
+                sync_mode = SYNC_SEQLOCK;
+            } else if (strcmp(argv[i], "buffers") == 0) {
+                sync_mode = SYNC_BUFFERED;
+            } else {
+                fprintf(stderr, "Modo de sincronización desconocido: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--buffers") == 0 && i + 1 < argc) {
+            int count = atoi(argv[++i]);
+            if (count < EXT_BUFFERS_MIN || count > EXT_BUFFERS_MAX) {
+                fprintf(stderr, "--buffers debe estar entre %d y %d\n", EXT_BUFFERS_MIN, EXT_BUFFERS_MAX);
+                exit(EXIT_FAILURE);
+            }
+            buffer_count = count;
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            bench_games = atoi(argv[++i]);
+            if (bench_games <= 0) {
+                fprintf(stderr, "La cantidad de partidas del benchmark debe ser positiva\n");
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--bench-out") == 0 && i + 1 < argc) {
+            bench_out = argv[++i];
+        } else if (strcmp(argv[i], "--bench-format") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "json") == 0) {
+                bench_format = BENCH_JSON;
+            } else if (strcmp(argv[i], "csv") == 0) {
+                bench_format = BENCH_CSV;
+            } else {
+                fprintf(stderr, "Formato de reporte desconocido: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--ns") == 0 && i + 1 < argc) {
+            char ns[NS_MAX + 1]; // uno más para que ns_set rechace los que no entran
+            i++;
+            if (strcmp(argv[i], "auto") == 0) {
+                snprintf(ns, sizeof(ns), "%d", getpid());
+            } else {
+                snprintf(ns, sizeof(ns), "%s", argv[i]);
+            }
+            if (!ns_set(ns)) {
+                fprintf(stderr, "Namespace inválido: %s (letras, números, '-' y '_', hasta %d caracteres)\n", argv[i], NS_MAX - 1);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--prefault") == 0) {
+            map_flags |= EXT_PREFAULT;
+        } else if (strcmp(argv[i], "--hugepages") == 0) {
+            map_flags |= EXT_HUGEPAGES;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--telemetry") == 0) {
+            telemetry_enabled = true;
+        } else if (strcmp(argv[i], "--tick") == 0) {
+            tick_mode = true;
+        } else if (strcmp(argv[i], "--view-fps") == 0 && i + 1 < argc) {
+            int fps = atoi(argv[++i]);
+            if (fps <= 0) {
+                fprintf(stderr, "--view-fps debe ser positivo\n");
+                exit(EXIT_FAILURE);
+            }
+            view_fps = fps;
+        } else if (strcmp(argv[i], "--max-stale") == 0 && i + 1 < argc) {
+            int stale = atoi(argv[++i]);
+            if (stale <= 0) {
+                fprintf(stderr, "--max-stale debe ser positivo\n");
+                exit(EXIT_FAILURE);
+            }
+            max_stale = stale;
+        } else if (strcmp(argv[i], "--rng") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "rand") == 0) {
+                board_generator = BOARD_RAND;
+            } else if (strcmp(argv[i], "counter") == 0) {
+                board_generator = BOARD_COUNTER;
+            } else {
+                fprintf(stderr, "Generador desconocido: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
         } else if (strcmp(argv[i], "-p") == 0) {
             if (player_count >= MAX_PLAYERS) {
                 fprintf(stderr, "Número máximo de jugadores alcanzado: %d\n", MAX_PLAYERS);
@@ -163,70 +355,6 @@ void validate_args(int argc, char* argv[]) {
     }
 }
 
-void init_game_state(GameState* state) {
-    state->width = width;
-    state->height = height;
-    state->player_count = player_count;
-    state->is_finished = false;
-
-    // Inicializar el tablero
-    srand(seed);
-    for (int i = 0; i < width * height; i++) {
-        state->board[i] = (rand() % 9) + 1; // Valores aleatorios entre 1 y 9
-    }
-
-    // Calcular el centro de la elipse
-    int center_x = width / 2;
-    int center_y = height / 2;
-
-    // Calcular los semiejes de la elipse
-    double semi_major_axis = width * 0.3;  // Eje mayor (30% del ancho del tablero)
-    double semi_minor_axis = height * 0.3; // Eje menor (30% del alto del tablero)
-
-    // if (player_count >= 5) {
-    //     semi_major_axis = width * 0.4;  // Eje mayor (40% del ancho del tablero)
-    //     semi_minor_axis = height * 0.4; // Eje menor (40% del alto del tablero)
-    // }
-
-    // Inicializar jugadores
-    for (int i = 0; i < player_count; i++) {
-        state->players[i].score = 0;
-        state->players[i].invalid_moves = 0;
-        state->players[i].valid_moves = 0;
-        state->players[i].is_blocked = false;
-        state->players[i].pid = -1;
-
-        // Obtener el nombre del jugador
-        char* last_slash = strrchr(player_paths[i], '/');
-        if (last_slash != NULL) {
-            strncpy(state->players[i].name, last_slash + 1, MAX_NAME - 1);
-        } else {
-            strncpy(state->players[i].name, player_paths[i], MAX_NAME - 1);
-        }
-        state->players[i].name[MAX_NAME - 1] = '\0'; // Asegurarse de que la cadena esté terminada
-
-        // Calcular la posición del jugador en la elipse
-        double angle = (2 * M_PI / player_count) * i; // Ángulo en radianes
-        int x = center_x + (int)(semi_major_axis * cos(angle));
-        int y = center_y + (int)(semi_minor_axis * sin(angle));
-
-        // Asegurarse de que las posiciones estén dentro de los límites del tablero
-        x = (x < 0) ? 0 : (x >= width ? width - 1 : x);
-        y = (y < 0) ? 0 : (y >= height ? height - 1 : y);
-
-        state->players[i].x = x;
-        state->players[i].y = y;
-
-        if (player_count == 1) {
-            // Si solo hay un jugador, va al centro, como ChompChamps
-            state->players[i].x = center_x;
-            state->players[i].y = center_y;
-        }
-
-        // Marcar la celda como ocupada por el jugador
-        state->board[state->players[i].y * width + state->players[i].x] = -i;
-    }
-}
 
 void init_sync_state(SyncState* sync) {
     sem_init(&sync->changes_available, 1, 0);
@@ -241,6 +369,11 @@ void init_sync_state(SyncState* sync) {
 // Se crean los pipes y se redirige la salida estándar de cada jugador al pipe correspondiente
 void create_players(GameState* state) {
     for (int i = 0; i < player_count; i++) {
+        processes[i].plugin = NULL;
+        if (plugin_is_path(player_paths[i])) {
+            processes[i].active = false; // se carga en create_plugins
+            continue;
+        }
         int pipefd[2];
 
 
@@ -248,8 +381,8 @@ void create_players(GameState* state) {
             perror("pipe");
             exit(1);
         }
-        char fifo_path[20];
-        snprintf(fifo_path, sizeof(fifo_path), "/tmp/pipe_player_%d", i);
+        char fifo_path[NS_NAME_MAX];
+        ns_fifo_path(fifo_path, sizeof(fifo_path), i);
         if(mkfifo(fifo_path, 0666)) // Crea un FIFO para el jugador
         {
             perror("mkfifo");
@@ -304,7 +437,37 @@ void create_players(GameState* state) {
             processes[i].pipe_read_fd = fd;
             state->players[i].pid = pid;
             processes[i].active = true; // El jugador está activo
+            processes[i].pending_head = 0;
+            processes[i].pending_count = 0;
+            processes[i].partial_len = 0;
+            processes[i].moved_version = 0;
+            processes[i].versioned = false;
+            fcntl(fd, F_SETFL, O_NONBLOCK); // se vacía el pipe entero en cada lectura
+        }
+    }
+}
+
+// Carga los jugadores que son plugins. Va después de los fork (create_players, create_view) para que
+// los procesos hijos no hereden hilos. Los hilos esperan el estado inicial en el rwlock de los plugins.
+void create_plugins(GameState* state, GameExt* ext) {
+    plugin_count = 0;
+    for (int i = 0; i < player_count; i++) {
+        if (!plugin_is_path(player_paths[i])) continue;
+        plugin_count++;
+
+        processes[i].pending_head = 0;
+        processes[i].pending_count = 0;
+        processes[i].partial_len = 0;
+        processes[i].moved_version = 0;
+        processes[i].versioned = false;
+        processes[i].plugin = plugin_start(player_paths[i], i, state, ext, telemetry);
+        if (processes[i].plugin == NULL) {
+            continue; // como un player que no se pudo ejecutar: no juega
         }
+        processes[i].pid = getpid();
+        processes[i].pipe_read_fd = plugin_event_fd(processes[i].plugin);
+        processes[i].active = true;
+        state->players[i].pid = getpid();
     }
 }
 
@@ -332,134 +495,286 @@ void create_view() {
 }
 
 
-void modify_x_y_acording_to_dir(unsigned char dir, int* x, int* y) {
-    switch (dir) {
-        case 0: (*y)--; break;          // Arriba
-        case 1: (*x)++; (*y)--; break; // Arriba-Derecha
-        case 2: (*x)++; break;          // Derecha
-        case 3: (*x)++; (*y)++; break; // Abajo-Derecha
-        case 4: (*y)++; break;          // Abajo
-        case 5: (*x)--; (*y)++; break; // Abajo-Izquierda
-        case 6: (*x)--; break;          // Izquierda
-        case 7: (*x)--; (*y)--; break; // Arriba-Izquierda
+
+// Registra los pipes de los jugadores en el epoll
+void init_epoll() {
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd == -1) {
+        perror("epoll_create1");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < player_count; i++) {
+        if (!processes[i].active) continue;
+        struct epoll_event event = { .events = EPOLLIN, .data.u32 = i };
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, processes[i].pipe_read_fd, &event) == -1) {
+            perror("epoll_ctl");
+            exit(EXIT_FAILURE);
+        }
     }
 }
 
-bool validate_move(unsigned char dir, GameState* state, int my_id) {
-    int my_x = state->players[my_id].x;
-    int my_y = state->players[my_id].y;
-    int* board = state->board;
-    int width = state->width;
-    int height = state->height;
-    
-    // Verificar si la dirección es válida
-    int new_x = my_x;
-    int new_y = my_y;
+void count_discarded(unsigned int n) {
+    discarded_moves += n;
+    if (telemetry) telemetry_count(&telemetry->discarded_moves, n);
+}
 
-    // Calcular nueva posición según la dirección
-    modify_x_y_acording_to_dir(dir, &new_x, &new_y);
+// Encola un movimiento recibido. Con replace pisa al último encolado si también tiene versión: el
+// jugador decidió otra cosa con un estado más nuevo y el anterior ya no le sirve.
+// El que llama se asegura de que haya lugar en la cola.
+void queue_move(PlayerProc* proc, unsigned char dir, unsigned int version, bool replace) {
+    if (replace && proc->pending_count > 0) {
+        QueuedMove* last = &proc->pending[(proc->pending_head + proc->pending_count - 1) % PENDING_MAX];
+        if (last->version != NO_VERSION) {
+            last->dir = dir;
+            last->version = version;
+            count_discarded(1);
+            return;
+        }
+    }
+    QueuedMove* move = &proc->pending[(proc->pending_head + proc->pending_count) % PENDING_MAX];
+    move->dir = dir;
+    move->version = version;
+    proc->pending_count++;
+}
 
-    // Verificar límites del tablero
-    if (new_x < 0 || new_x >= width || new_y < 0 || new_y >= height) {
-        return false;
+// Procesa un byte del FIFO: o es una dirección suelta o es parte de un MoveMessage (que puede llegar
+// cortado entre dos lecturas). Solo los players que lo avisaron mandan MoveMessage; de los demás
+// todo byte es una dirección, aunque valga MOVE_MSG_MARKER. Devuelve 1 si completó un movimiento.
+int receive_byte(PlayerProc* proc, unsigned char byte) {
+    if (!proc->versioned || (proc->partial_len == 0 && byte != MOVE_MSG_MARKER)) {
+        queue_move(proc, byte, NO_VERSION, false);
+        return 1;
+    }
+    proc->partial[proc->partial_len++] = byte;
+    if (proc->partial_len < (int)sizeof(MoveMessage)) {
+        return 0;
     }
+    MoveMessage message;
+    memcpy(&message, proc->partial, sizeof(message));
+    proc->partial_len = 0;
+    queue_move(proc, message.dir, message.version, message.flags & MOVE_REPLACE);
+    return 1;
+}
 
-    // Verificar si la celda está ocupada
-    int index = new_y * width + new_x;
-    if (board[index] <= 0) {
-        return false;
+// Lee todo lo que haya en el pipe del jugador y lo encola. Si la cola se llena lo que sobra queda en el pipe.
+// Lo que manda un jugador bloqueado se descarta, como antes no se leía su pipe.
+// Devuelve la cantidad de movimientos recibidos (encolados o que reemplazaron a uno encolado).
+int drain_player_pipe(int index, GameState* state, GameExt* ext) {
+    PlayerProc* proc = &processes[index];
+    bool blocked = state->players[index].is_blocked;
+    int queued = 0;
+
+    if (proc->plugin != NULL) {
+        // Un plugin deja a lo sumo un movimiento y no decide otro hasta que se lo toma
+        int move = plugin_take_move(proc->plugin);
+        if (move == PLUGIN_DONE) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, proc->pipe_read_fd, NULL);
+            proc->active = false;
+        } else if (move != PLUGIN_NO_MOVE && !blocked && proc->pending_count < PENDING_MAX) {
+            queue_move(proc, move, NO_VERSION, false);
+            queued++;
+        }
+        return queued;
     }
 
-    return true;
+    while (proc->active) {
+        // Cada byte completa a lo sumo un movimiento, así que leyendo tantos bytes como lugares libres
+        // la cola no se puede llenar a mitad de un read
+        unsigned char buffer[PENDING_MAX];
+        int space = blocked ? PENDING_MAX : PENDING_MAX - proc->pending_count;
+        if (space == 0) break;
+
+        ssize_t n = read(proc->pipe_read_fd, buffer, space);
+        if (n > 0) {
+            // El player se anota antes de su primer write, así que si lo hizo ya se ve acá
+            if (!proc->versioned) {
+                proc->versioned = ext_sends_move_messages(ext, proc->pid);
+            }
+            for (int i = 0; i < n && !blocked; i++) {
+                queued += receive_byte(proc, buffer[i]);
+            }
+        } else if (n == 0) {
+            // EOF
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, proc->pipe_read_fd, NULL);
+            close(proc->pipe_read_fd);
+            proc->active = false;
+        } else if (errno != EINTR) {
+            break; // EAGAIN: no hay más por ahora
+        }
+    }
+    return queued;
 }
 
-// Chequea si todas las direcciones están bloqueadas
-bool is_blocked(int player_id, GameState* state) {
-    for (unsigned char dir = 0; dir < 8; dir++) {
-        if (validate_move(dir, state, player_id)) {
-            return false;
+bool has_pending_moves(GameState* state) {
+    for (int i = 0; i < player_count; i++) {
+        if (processes[i].pending_count > 0 && !state->players[i].is_blocked) {
+            return true;
         }
     }
-    return true;
+    return false;
 }
 
+// Un movimiento con versión está viejo si se decidió antes del último movimiento válido del jugador
+// (ya no sale de la posición con la que se calculó) o, con --max-stale, si pasaron más de max_stale
+// versiones del estado desde que se decidió
+bool is_stale(const PlayerProc* proc, const QueuedMove* move, unsigned int version) {
+    if (move->version == NO_VERSION) return false;
+    if ((int)(move->version - proc->moved_version) < 0) return true;
+    return max_stale > 0 && version - move->version > max_stale;
+}
 
-// Mueve al jugador a la nueva posición y actualiza el puntaje
-// y el tablero
-void move_player(int player_id, unsigned char dir, GameState* state) {
-    int* board = state->board;
-    int width = state->width;
-
-    // Obtener la posición actual del jugador
-    int my_x = state->players[player_id].x;
-    int my_y = state->players[player_id].y;
-
-    // Calcular nueva posición según la dirección
-    modify_x_y_acording_to_dir(dir, &my_x, &my_y);
+// Saca el primer movimiento encolado del jugador que no esté viejo; los viejos se descartan.
+// Devuelve false si no le queda ninguno.
+bool pop_pending_move(int index, unsigned int version, unsigned char* dir) {
+    PlayerProc* proc = &processes[index];
+    while (proc->pending_count > 0) {
+        QueuedMove* move = &proc->pending[proc->pending_head];
+        proc->pending_head = (proc->pending_head + 1) % PENDING_MAX;
+        proc->pending_count--;
+        if (is_stale(proc, move, version)) {
+            count_discarded(1);
+            continue;
+        }
+        *dir = move->dir;
+        return true;
+    }
+    return false;
+}
 
-    // Actualizar la posición del jugador
-    state->players[player_id].x = my_x;
-    state->players[player_id].y = my_y;
-    state->players[player_id].score += board[my_y * width + my_x]; // Sumar el valor de la celda al puntaje
+// Saca el próximo movimiento encolado, recorriendo los jugadores en ronda a partir del último que movió.
+// `version` es la versión actual del estado, para descartar los movimientos viejos.
+// Devuelve el índice del jugador o -1 si no hay movimientos.
+int next_pending_move(GameState* state, unsigned int version, unsigned char* dir) {
+    for (int offset = 1; offset <= player_count; offset++) {
+        int index = (offset + last_player_moved) % player_count; // Ciclo circular
 
-    // Actualizar el tablero
-    board[my_y * width + my_x] = -player_id; // Marcar la celda como ocupada por el jugador
+        if (state->players[index].is_blocked) {
+            processes[index].pending_count = 0;
+            continue;
+        }
+        if (pop_pending_move(index, version, dir)) {
+            return index;
+        }
+    }
+    return -1;
 }
 
-
-// Intenta mover al jugador en la dirección especificada
-void try_to_move_player(int player_id, unsigned char dir, GameState* state) {
-    if (validate_move(dir, state, player_id)) {
-        move_player(player_id, dir, state);
-        state->players[player_id].valid_moves++;
-    } else {
-        state->players[player_id].invalid_moves++;
+// Modo --tick: saca a lo sumo un movimiento encolado de cada jugador no bloqueado, en el orden en que se
+// van a aplicar. El orden rota en cada tick, así ningún jugador gana siempre los conflictos.
+// Devuelve la cantidad de movimientos del tick.
+int next_tick_moves(GameState* state, unsigned int version, PendingMove moves[]) {
+    int count = 0;
+    for (int offset = 0; offset < player_count; offset++) {
+        int index = (tick + offset) % player_count;
+
+        if (state->players[index].is_blocked) {
+            processes[index].pending_count = 0;
+            continue;
+        }
+        if (pop_pending_move(index, version, &moves[count].dir)) {
+            moves[count].player_id = index;
+            count++;
+        }
     }
+    if (count > 0) tick++;
+    return count;
 }
 
-// Verifica si todos los jugadores están bloqueados
-bool check_for_blocking(GameState* state) {
-    bool all_blocked = true;
-    for (int player_id = 0; player_id < state->player_count; player_id++) {
-        if (!state->players[player_id].is_blocked) {
-            bool blocked = is_blocked(player_id, state);
-            state->players[player_id].is_blocked = blocked;
-            if (!blocked) {
-                all_blocked = false;
-            }
+// --sync buffers: pone al día un buffer que nadie esté leyendo con el estado actual y lo publica. Solo se
+// copian el encabezado y las celdas que cambiaron desde la última vez que se escribió ese buffer (la
+// bitácora), salvo la primera vez o si quedó más atrasado que la bitácora.
+// Si no hay ninguna copia libre no espera: deja buffer_behind en true y devuelve false; se reintenta
+// después de la próxima escritura o, si no llega ningún movimiento, a los BUFFER_RETRY_MS.
+bool publish_buffer(GameState* state, GameExt* ext) {
+    unsigned int index = ext_buffer_back(ext);
+    buffer_behind = index == EXT_NO_BUFFER;
+    if (buffer_behind) return false;
+    GameState* buffer = ext_buffer(buffers, buffer_stride, index);
+    unsigned int head = ext->journal_head;
+    unsigned int applied = ext->buffer_journal[index];
+
+    memcpy(buffer, state, sizeof(GameState));
+    if (buffer_loaded[index] && head - applied <= JOURNAL_SIZE) {
+        for (; applied != head; applied++) {
+            const JournalEntry* entry = &ext->journal[(applied + 1) & (JOURNAL_SIZE - 1)];
+            buffer->board[entry->to] = -entry->player_id;
         }
+    } else {
+        memcpy(buffer->board, state->board, sizeof(cell_t) * width * height);
+        buffer_loaded[index] = true;
     }
-    return all_blocked;
+    ext->buffer_journal[index] = head;
+    ext->buffer_version[index] = ext->version;
+    ext_buffer_flip(ext, index);
+    return true;
 }
 
-int main(int argc, char* argv[]) {
-    // Validar argumentos
-    validate_args(argc, argv);
-    system("clear");
+// Espera a que la vista termine de dibujar
+void wait_for_view(SyncState* sync) {
+    uint64_t wait_ns = telemetry ? telemetry_now_ns() : 0;
+    sem_wait(&sync->print_done);
+    if (telemetry) telemetry_record(&telemetry->view_wait, telemetry_now_ns() - wait_ns);
+}
+
+// Corre una partida completa: crea la memoria compartida, los jugadores y la vista, juega y limpia.
+// Si stats no es NULL (modo benchmark) se toman tiempos y no se imprime nada.
+void run_game(BenchGame* stats) {
+    uint64_t start_ns = stats ? bench_now_ns() : 0;
+    uint64_t publish_ns = 0; // última publicación del estado, para la latencia de los movimientos
+    last_player_moved = 0;
+    tick = 0;
+    discarded_moves = 0;
+
+    // Nombres de los segmentos dentro del namespace de la partida (sin --ns, los del enunciado)
+    char state_name[NS_NAME_MAX], sync_name[NS_NAME_MAX];
+    ns_name(state_name, sizeof(state_name), SHM_STATE);
+    ns_name(sync_name, sizeof(sync_name), SHM_SYNC);
 
     // Crear memoria compartida del estado (solo máster la puede escribir, los demás la leen)
-    int shm_fd = shm_open(SHM_STATE, O_CREAT | O_RDWR, 0644);
+    int shm_fd = shm_open(state_name, O_CREAT | O_RDWR, 0644);
     if (shm_fd < 0) {
         perror("shm_open state");
         exit(EXIT_FAILURE);
     }
-    if(ftruncate(shm_fd, sizeof(GameState) + sizeof(int) * width * height) == -1) {
+    size_t state_size = ext_state_map_size(sizeof(GameState) + sizeof(cell_t) * width * height, map_flags);
+    if(ftruncate(shm_fd, state_size) == -1) {
         perror("ftruncate state");
         exit(EXIT_FAILURE);
     }
 
     
-    GameState* state = mmap(NULL, sizeof(GameState) + sizeof(int) * width * height, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    GameState* state = mmap(NULL, state_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
     if (state == MAP_FAILED) {
         perror("mmap state");
         exit(EXIT_FAILURE);
     }
+    ext_prepare_mapping(state, state_size, map_flags); // antes de escribirlo, para que las páginas grandes apliquen
     
     // Inicializar el estado del juego
-    init_game_state(state);
+    init_game_state(state, width, height, seed, board_generator, player_count, player_paths);
+    RulesGame rules;
+    if (!rules_attach(&rules, state)) {
+        perror("malloc free_neighbours");
+        exit(EXIT_FAILURE);
+    }
+
+    // Grabación: el encabezado ya tiene todo lo necesario para rearmar este estado inicial
+    RecordWriter recorder = { .fd = -1, .header = NULL };
+    if (record_path != NULL) {
+        char path[1024];
+        if (bench_games > 0) {
+            snprintf(path, sizeof(path), "%s.%u", record_path, seed);
+        } else {
+            snprintf(path, sizeof(path), "%s", record_path);
+        }
+        if (!record_create(&recorder, path, seed, width, height, player_count, state->players,
+                           board_generator == BOARD_COUNTER ? RECORD_BOARD_COUNTER : 0)) {
+            exit(EXIT_FAILURE);
+        }
+    }
     
     // Crear memoria compartida de sincronización
-    int shm_sync_fd = shm_open(SHM_SYNC, O_CREAT | O_RDWR, 0666);
+    int shm_sync_fd = shm_open(sync_name, O_CREAT | O_RDWR, 0666);
     fchmod(shm_sync_fd, 0666);
     ftruncate(shm_sync_fd, sizeof(SyncState));
     SyncState* sync = mmap(NULL, sizeof(SyncState), PROT_READ | PROT_WRITE, MAP_SHARED, shm_sync_fd, 0);
@@ -467,113 +782,230 @@ int main(int argc, char* argv[]) {
     // Inicializar semáforos
     init_sync_state(sync);
 
+    // Segmento de extensiones (seqlock, etc.); los lectores lo encuentran por nombre
+    GameExt* ext = ext_create(sync_mode, sizeof(cell_t), map_flags);
+    if (ext == NULL) {
+        exit(EXIT_FAILURE);
+    }
+    ext->view_fps = view_fps;
+    if (sync_mode == SYNC_BUFFERED) {
+        ext->buffer_count = buffer_count;
+        buffer_stride = ext_buffer_stride(sizeof(GameState) + sizeof(cell_t) * width * height);
+        buffers = ext_buffers_create(ext, buffer_stride);
+        if (buffers == NULL) {
+            exit(EXIT_FAILURE);
+        }
+        memset(buffer_loaded, 0, sizeof(buffer_loaded));
+        buffer_behind = false;
+    }
+
+    // Con --view-fps la vista va por su cuenta: no hay changes_available/print_done ni delay (se ignora -d)
+    bool view_handshake = view != NULL && view_fps == 0;
+
+    // Telemetría: va antes de crear los hijos para que la encuentren al arrancar
+    if (telemetry_enabled) {
+        telemetry = telemetry_create();
+        if (telemetry == NULL) {
+            exit(EXIT_FAILURE);
+        }
+        telemetry->player_count = player_count;
+        for (int i = 0; i < player_count; i++) {
+            memcpy(telemetry->names[i], state->players[i].name, MAX_NAME);
+        }
+    }
+
+
+    if (!stats) printf("Máster listo. Memoria y semáforos inicializados.\n");
 
-    printf("Máster listo. Memoria y semáforos inicializados.\n");
 
+    // Los hilos de los plugins leen el estado con un rwlock propio; el máster lo toma para escribir
+    // y lo tiene desde ahora hasta publicar el estado inicial
+    bool has_plugins = false;
+    for (int i = 0; i < player_count; i++) {
+        has_plugins = has_plugins || plugin_is_path(player_paths[i]);
+    }
+    if (has_plugins) plugin_state_lock();
 
     create_players(state);
     create_view();
+    create_plugins(state, ext);
+    init_epoll();
+
+    // Con --prefault el reloj arranca cuando todos los lectores ya tienen el estado en memoria
+    if (map_flags & EXT_PREFAULT) {
+        unsigned int readers = player_count - plugin_count + (view ? 1 : 0);
+        if (!ext_wait_ready(ext, readers, timeout * 1000) && !stats) {
+            printf("No todos los procesos avisaron que prepararon la memoria, se empieza igual.\n");
+        }
+    }
     update_last_msg_time();   // guarda el tiempo actual para después calcular el timeout
 
-    if(view) sem_post(&sync->changes_available);
+    if (telemetry) __atomic_store_n(&telemetry->last_publish_ns, telemetry_now_ns(), __ATOMIC_RELAXED);
+    if (view_handshake) sem_post(&sync->changes_available);
     sem_post(&sync->game_state_mutex);
+    ext_write_end(ext); // seqlock: el estado inicial queda publicado
+    if (has_plugins) plugin_state_unlock();
+    if (buffers) publish_buffer(state, ext);
+    ext_publish(ext);
+    if (stats) {
+        publish_ns = bench_now_ns();
+        stats->startup_ns = publish_ns - start_ns;
+    }
 
     #ifdef DELAY_INCLUDES_VIEW
-        if(view) sem_wait(&sync->print_done);
+        if (view_handshake) wait_for_view(sync);
     #endif
 
-    if(view) usleep(delay * 1000); // Espera el delay antes de continuar
+    if (view_handshake) usleep(delay * 1000); // Espera el delay antes de continuar
 
     while (!state->is_finished) {
 
-        unsigned char dir;
-        int player_id;
-
-        fd_set read_fds;
-        FD_ZERO(&read_fds);
-        int max_fd = -1;
-
-        for (int i = 0; i < player_count; i++) {
-            // agrega los pipes de los jugadores activos a la lista de lectura
-            if (!state->players[i].is_blocked && processes[i].active) {
-                FD_SET(processes[i].pipe_read_fd, &read_fds);
-                if (processes[i].pipe_read_fd > max_fd)
-                    max_fd = processes[i].pipe_read_fd;
-            }
-        }
-
-        int remaining_timeout = get_remaining_timeout_sec(timeout);
-        struct timeval tv = { .tv_sec = remaining_timeout, .tv_usec = 0 };
-        int ready = select(max_fd + 1, &read_fds, NULL, NULL, &tv);
+        PendingMove moves[MAX_PLAYERS]; // lo que se aplica en esta vuelta: uno, o uno por jugador con --tick
+        int move_count = 0;
 
         bool no_moves_found = false;
 
-        if (ready < 0) {
-            perror("select");
-            break;
-        } else if (ready == 0 || (remaining_timeout == 0 && TIMEOUT_INCLUDES_DELAY)) {
-            // Timeout, no hay movimientos disponibles
-            printf("Timeout, no hay movimientos disponibles.\n");
-            no_moves_found = true;
+        // Solo se vuelve al kernel cuando se aplicaron todos los movimientos encolados:
+        // en cada despertada se vacían los pipes de todos los jugadores listos.
+        // Con --tick se mira igual (sin esperar) para que el tick incluya a los que acaban de escribir.
+        bool pending = has_pending_moves(state);
+        if (!pending || tick_mode) {
+            int remaining_timeout = pending ? 0 : get_remaining_timeout_ms(timeout);
+            // Con una publicación salteada (--sync buffers) no se duerme más de BUFFER_RETRY_MS: los
+            // players pueden estar esperando ese estado para mandar su próximo movimiento
+            bool retry = buffer_behind && remaining_timeout > BUFFER_RETRY_MS;
+            struct epoll_event events[MAX_PLAYERS];
+            int ready = epoll_wait(epoll_fd, events, MAX_PLAYERS, retry ? BUFFER_RETRY_MS : remaining_timeout);
+
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                perror("epoll_wait");
+                break;
+            } else if (ready == 0 && retry) {
+                if (publish_buffer(state, ext)) ext_publish(ext);
+                continue;
+            } else if (!pending && (ready == 0 || (remaining_timeout == 0 && TIMEOUT_INCLUDES_DELAY))) {
+                // Timeout, no hay movimientos disponibles
+                if (!stats) printf("Timeout, no hay movimientos disponibles.\n");
+                no_moves_found = true;
+            } else {
+                uint64_t arrival_ns = stats ? bench_now_ns() : 0;
+                for (int e = 0; e < ready; e++) {
+                    int queued = drain_player_pipe(events[e].data.u32, state, ext);
+                    if (stats) samples_add(&stats->latency, arrival_ns - publish_ns, queued);
+                }
+            }
         }
-        
 
-        for (int offset = 1; offset <= player_count; offset++) {
-            int index = (offset + last_player_moved) % player_count; // Ciclo circular
-            
-            
-            int fd = processes[index].pipe_read_fd;
-            if (FD_ISSET(fd, &read_fds)) {
-                unsigned char mov;
-                int n = read(fd, &mov, 1);
-                
-                if (n == 1) {
-                    dir = mov;
-                    player_id = index;
-                    last_player_moved = index;
-                    update_last_msg_time();
-                    break;
-                } else {
-                    // EOF
-                    close(fd);
-                    processes[index].active = false;
-                }
+        if (!no_moves_found) {
+            if (tick_mode) {
+                move_count = next_tick_moves(state, ext->version, moves);
+            } else {
+                moves[0].player_id = next_pending_move(state, ext->version, &moves[0].dir);
+                move_count = moves[0].player_id == -1 ? 0 : 1;
             }
+            if (move_count == 0) {
+                continue; // solo hubo EOFs
+            }
+            last_player_moved = moves[move_count - 1].player_id;
+            update_last_msg_time();
         }
 
 
         // Si la vista actualiza "asincrónicamente" mientras leemos el pipe, solo la tengo que esperar al modificar el estado
         #ifndef DELAY_INCLUDES_VIEW
-            if(view) sem_wait(&sync->print_done);
+            if (view_handshake) wait_for_view(sync);
         #endif
         
         // Para modificar el estado del juego, el máster debe tener el mutex (avisa con el de starvation que quiere entrar)
-        sem_wait(&sync->starvation_mutex);
-        sem_wait(&sync->game_state_mutex);
-        sem_post(&sync->starvation_mutex);
+        // Con seqlock no se espera a nadie: los lectores detectan la escritura por el contador y reintentan.
+        // El contador avanza en los dos modos, así la vista con --view-fps copia sin tomar el lightswitch.
+        uint64_t wait_ns = telemetry ? telemetry_now_ns() : 0;
+        // Con buffers los players no leen este estado, leen las copias publicadas
+        if (sync_mode == SYNC_LIGHTSWITCH) {
+            sem_wait(&sync->starvation_mutex);
+            sem_wait(&sync->game_state_mutex);
+            sem_post(&sync->starvation_mutex);
+        }
+        ext_write_begin(ext);
+        if (has_plugins) plugin_state_lock();
+        uint64_t lock_ns = stats || telemetry ? bench_now_ns() : 0;
+        if (telemetry) telemetry_record(&telemetry->lock_wait, lock_ns - wait_ns);
+        // Lo que lean desde ahora los players sale con esta versión
+        __atomic_store_n(&ext->version, ext->version + 1, __ATOMIC_RELAXED);
         
         if (no_moves_found) {
             // Si no hay movimientos pendientes, se termina el juego   
             state->is_finished = true;
-            
-        }else{
-            // Movimiento del jugador y validación de condición de fin
-            try_to_move_player(player_id, dir, state);
-            state->is_finished = check_for_blocking(state);
+        }
+
+        // Movimientos de los jugadores y validación de condición de fin. Si la partida termina a mitad
+        // de un tick, lo que queda no se aplica (como cualquier movimiento que llega tarde).
+        for (int m = 0; m < move_count && !state->is_finished; m++) {
+            int player_id = moves[m].player_id;
+            unsigned char dir = moves[m].dir;
+            Player* player = &state->players[player_id];
+            if (player->is_blocked) continue; // lo bloqueó otro movimiento del mismo tick
+            JournalEntry entry = { .player_id = player_id, .from = player->y * width + player->x, .score_delta = player->score };
+
+            bool moved = play_move(&rules, player_id, dir);
+            if (moved) processes[player_id].moved_version = ext->version;
+            record_move(&recorder, player_id, dir, moved);
+            if (telemetry) {
+                telemetry_count(&telemetry->moves, 1);
+                if (!moved) telemetry_count(&telemetry->invalid_moves, 1);
+            }
+            if (stats) {
+                stats->moves++;
+                if (moved) stats->valid_moves++; else stats->invalid_moves++;
+            }
+
+            // Los lectores actualizan su copia del tablero con la bitácora en lugar de copiarlo entero
+            if (moved) {
+                entry.to = player->y * width + player->x;
+                entry.score_delta = player->score - entry.score_delta;
+                entry.blocked = blocked_mask(state);
+                ext_journal_append(ext, &entry);
+            }
         }
         
 
-        if(view) sem_post(&sync->changes_available);
-        sem_post(&sync->game_state_mutex);
+        if (telemetry) {
+            uint64_t unlock_ns = telemetry_now_ns();
+            telemetry_record(&telemetry->hold, unlock_ns - lock_ns);
+            __atomic_store_n(&telemetry->last_publish_ns, unlock_ns, __ATOMIC_RELAXED);
+        }
+        if (view_handshake) sem_post(&sync->changes_available);
+        if (has_plugins) plugin_state_unlock();
+        ext_write_end(ext);
+        if (sync_mode == SYNC_LIGHTSWITCH) {
+            sem_post(&sync->game_state_mutex);
+        }
+        if (buffers) publish_buffer(state, ext);
+        ext_publish(ext); // despierta a los players que esperan un estado nuevo
+        if (stats) {
+            publish_ns = bench_now_ns();
+            samples_add(&stats->hold, publish_ns - lock_ns, 1);
+        }
 
         // Si quiero que la vista bloquee el master y que el delay se sume a lo que tarde la vista, tengo que esperar acá a que imprima
         #ifdef DELAY_INCLUDES_VIEW
-            if(view) sem_wait(&sync->print_done);
+            if (view_handshake) wait_for_view(sync);
         #endif
 
-        if(view) usleep(delay * 1000);
+        if (view_handshake) usleep(delay * 1000);
+    }
+
+    if (stats) {
+        stats->game_ns = bench_now_ns() - (start_ns + stats->startup_ns);
+        stats->discarded_moves = discarded_moves;
     }
 
+    // Con --view-fps nunca se le avisó a la vista. Una que no lee view_fps (la de la cátedra) sigue
+    // esperando changes_available desde el principio: con un aviso dibuja el estado final y termina.
+    // A la vista del TP el aviso de más no le cambia nada.
+    if (view && !view_handshake) sem_post(&sync->changes_available);
+
     // Espero a que la view termine
     if (view) {
         int status;
@@ -589,13 +1021,26 @@ int main(int argc, char* argv[]) {
 
     // Espero a que los hijos terminen e imprimo sus resultados
     for (int i = 0; i < player_count; i++) {
+        if (plugin_is_path(player_paths[i])) {
+            // Los plugins no tienen proceso ni FIFO: se espera el hilo
+            if (processes[i].plugin != NULL) {
+                plugin_join(processes[i].plugin);
+                if (!stats) {
+                    printf("Player %s (%d) exited (%d) with a score of %u / %u / %u\n",
+                           state->players[i].name, i, 0,
+                           state->players[i].score, state->players[i].valid_moves,
+                           state->players[i].invalid_moves);
+                }
+            }
+            continue;
+        }
         int status;
         int pid = waitpid(processes[i].pid, &status, 0);
         if (pid == -1) {
             perror("waitpid");
 
         }
-        if (WIFEXITED(status)){
+        if (WIFEXITED(status) && !stats){
             int exit_code = WEXITSTATUS(status);
             // Player player (0) exited (0) with a score of 0 / 0 / 0
             printf("Player %s (%d) exited (%d) with a score of %u / %u / %u\n", 
@@ -608,8 +1053,8 @@ int main(int argc, char* argv[]) {
             close(processes[i].pipe_read_fd);
         }
         // Eliminar el FIFO
-        char fifo_path[20];
-        snprintf(fifo_path, sizeof(fifo_path), "/tmp/pipe_player_%d", i);
+        char fifo_path[NS_NAME_MAX];
+        ns_fifo_path(fifo_path, sizeof(fifo_path), i);
         if (unlink(fifo_path) == -1) {
             perror("unlink fifo");
         }
@@ -617,8 +1062,12 @@ int main(int argc, char* argv[]) {
 
 
 
+    close(epoll_fd);
+    rules_detach(&rules);
+    record_close(&recorder);
+
     // Limpiar memoria compartida
-    if (munmap(state, sizeof(GameState) + sizeof(int) * width * height) == -1) {
+    if (munmap(state, state_size) == -1) {
         perror("munmap state");
     }
     if (munmap(sync, sizeof(SyncState)) == -1) {
@@ -630,13 +1079,64 @@ int main(int argc, char* argv[]) {
     if (close(shm_sync_fd) == -1) {
         perror("close shm_sync_fd");
     }
-    if (shm_unlink(SHM_STATE) == -1) {
+    if (shm_unlink(state_name) == -1) {
         perror("shm_unlink state");
     }
-    if (shm_unlink(SHM_SYNC) == -1) {
+    if (shm_unlink(sync_name) == -1) {
         perror("shm_unlink sync");
     }
-    printf("Máster terminado.\n");
+    ext_buffers_destroy(buffers, ext, buffer_stride);
+    buffers = NULL;
+    ext_destroy(ext);
+    telemetry_destroy(telemetry);
+    telemetry = NULL;
+
+    if (stats) {
+        stats->wall_ns = bench_now_ns() - start_ns;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Validar argumentos
+    validate_args(argc, argv);
+
+    if (bench_games == 0) {
+        if (isatty(STDOUT_FILENO)) system("clear");
+        run_game(NULL);
+        printf("Máster terminado.\n");
+        return 0;
+    }
+
+    // Modo benchmark: sin vista, una partida atrás de otra
+    view = NULL;
+    BenchGame* games = calloc(bench_games, sizeof(BenchGame));
+    if (games == NULL) {
+        perror("calloc benchmark");
+        exit(EXIT_FAILURE);
+    }
+
+    unsigned int first_seed = seed;
+    for (int g = 0; g < bench_games; g++) {
+        seed = first_seed + g;
+        bench_game_init(&games[g], seed);
+        run_game(&games[g]);
+    }
+
+    FILE* out = stdout;
+    if (bench_out != NULL) {
+        out = fopen(bench_out, "w");
+        if (out == NULL) {
+            perror("fopen benchmark");
+            exit(EXIT_FAILURE);
+        }
+    }
+    bench_write_report(out, bench_format, games, bench_games, (const char**)player_paths, player_count);
+    if (out != stdout) fclose(out);
+
+    for (int g = 0; g < bench_games; g++) {
+        bench_game_free(&games[g]);
+    }
+    free(games);
     return 0;
 }
 
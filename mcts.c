@@ -0,0 +1,409 @@
+// mcts.c
+#define _POSIX_C_SOURCE 200112L // clock_gettime
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mcts.h"
+#include "game_rules.h"
+
+#define HORIZON 48          // movimientos propios por simulación, contando árbol y rollout
+#define NODE_POOL (1 << 17) // nodos por arena; con el árbol lleno se siguen haciendo rollouts desde las hojas
+#define EXPLORATION 0.7     // constante de UCT, las recompensas están entre 0 y 1
+#define NO_NODE -1
+
+typedef struct {
+    int children[DIRECTIONS]; // índice en la arena o NO_NODE
+    int visits;               // se incrementa al bajar, antes de simular (pérdida virtual)
+    double total;             // suma de las recompensas de las simulaciones que pasaron por acá
+} Node;
+
+// El árbol vive en una arena; para reutilizar un subárbol se copia a la otra y se descarta el resto
+static Node* arenas[2] = { NULL, NULL };
+static int arena = 0;
+static int node_count = 0;
+static int root = NO_NODE;
+static pthread_mutex_t tree_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Posición y respuesta del turno anterior, para saber qué parte del árbol sigue valiendo
+static int last_x = -1;
+static int last_y = -1;
+static int last_dir = -1;
+
+// Estado desde el que se busca en este turno, los hilos solo lo leen
+static int width = 0;
+static int height = 0;
+static const cell_t* root_board = NULL;
+static SearchPlayer root_players[MAX_PLAYERS];
+static int root_player_count = 0;
+static int root_me = 0;
+static struct timespec deadline;
+
+typedef struct {
+    int index;
+    cell_t value;
+} UndoEntry;
+
+// Cada hilo simula sobre su copia del tablero y la restaura deshaciendo lo que anotó,
+// así no hay que copiar el tablero entero en cada simulación
+typedef struct {
+    pthread_t thread;
+    cell_t* board;
+    UndoEntry undo[HORIZON * MAX_PLAYERS];
+    int undo_count;
+    SearchPlayer players[MAX_PLAYERS];
+    int path[HORIZON + 1];
+    uint64_t rng;
+} Worker;
+
+static Worker* workers = NULL;
+static int worker_slots = 0; // Worker pedidos, aunque no se hayan podido crear todos los hilos
+static int worker_count = 0; // el 0 es el hilo que llama a mcts_get_movement
+
+// Pool: cada turno se incrementa search_round y los hilos buscan hasta el deadline
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static unsigned int search_round = 0;
+static int running = 0;
+static bool shutting_down = false;
+
+static uint32_t next_random(Worker* w) {
+    // xorshift64*
+    w->rng ^= w->rng >> 12;
+    w->rng ^= w->rng << 25;
+    w->rng ^= w->rng >> 27;
+    return (uint32_t)((w->rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static unsigned char legal_mask(const cell_t* board, int x, int y) {
+    unsigned char mask = 0;
+    for (int dir = 0; dir < DIRECTIONS; dir++) {
+        int nx = x + dx[dir];
+        int ny = y + dy[dir];
+        if (nx >= 0 && ny >= 0 && nx < width && ny < height && board[ny * width + nx] > 0) {
+            mask |= 1 << dir;
+        }
+    }
+    return mask;
+}
+
+// Dirección al azar entre las prendidas en mask (no vacía)
+static int random_dir(Worker* w, unsigned char mask) {
+    int k = next_random(w) % __builtin_popcount(mask);
+    for (int dir = 0; dir < DIRECTIONS; dir++) {
+        if ((mask & (1 << dir)) && k-- == 0) return dir;
+    }
+    return -1;
+}
+
+static int occupy(Worker* w, int id, int dir) {
+    SearchPlayer* player = &w->players[id];
+    player->x += dx[dir];
+    player->y += dy[dir];
+    int index = player->y * width + player->x;
+    int value = w->board[index];
+    w->undo[w->undo_count++] = (UndoEntry){ index, (cell_t)value };
+    w->board[index] = -id;
+    return value;
+}
+
+// Un paso de la simulación: me muevo en dir y después cada rival hace un movimiento al azar.
+// Devuelve lo que sumé.
+static int step(Worker* w, int dir) {
+    int gained = occupy(w, root_me, dir);
+    for (int i = 0; i < root_player_count; i++) {
+        SearchPlayer* player = &w->players[i];
+        if (i == root_me || player->blocked) continue;
+        unsigned char mask = legal_mask(w->board, player->x, player->y);
+        if (mask == 0) {
+            player->blocked = true;
+            continue;
+        }
+        occupy(w, i, random_dir(w, mask));
+    }
+    return gained;
+}
+
+static int new_node() {
+    if (node_count == NODE_POOL) return NO_NODE;
+    Node* node = &arenas[arena][node_count];
+    for (int dir = 0; dir < DIRECTIONS; dir++) {
+        node->children[dir] = NO_NODE;
+    }
+    node->visits = 0;
+    node->total = 0;
+    return node_count++;
+}
+
+// Hijo con mejor UCT entre los movimientos legales ya expandidos, -1 si no hay ninguno
+static int select_child(const Node* nodes, const Node* node, unsigned char mask) {
+    double log_visits = log(node->visits);
+    double best_value = -1;
+    int best_dir = -1;
+    for (int dir = 0; dir < DIRECTIONS; dir++) {
+        if (!(mask & (1 << dir)) || node->children[dir] == NO_NODE) continue;
+        const Node* child = &nodes[node->children[dir]];
+        double value = child->total / child->visits + EXPLORATION * sqrt(log_visits / child->visits);
+        if (value > best_value) {
+            best_value = value;
+            best_dir = dir;
+        }
+    }
+    return best_dir;
+}
+
+// Una simulación: baja por el árbol con UCT, expande un hijo, termina al azar hasta HORIZON
+// y propaga la recompensa (lo que sumé, normalizado) por el camino.
+// El árbol se toma solo para elegir (o crear) cada hijo; los pasos se simulan sin el lock, sobre el
+// tablero del hilo. Mientras tanto la visita ya contada hace que los demás hilos prueben otros caminos.
+static void simulate(Worker* w) {
+    memcpy(w->players, root_players, sizeof(SearchPlayer) * root_player_count);
+    w->undo_count = 0;
+    SearchPlayer* me = &w->players[root_me];
+    int gained = 0;
+    int depth = 0;
+    int path_length = 0;
+
+    Node* nodes = arenas[arena]; // la arena solo cambia entre búsquedas (reuse_tree)
+    int node = root;
+    pthread_mutex_lock(&tree_mutex);
+    nodes[node].visits++;
+    pthread_mutex_unlock(&tree_mutex);
+    w->path[path_length++] = node;
+
+    while (depth < HORIZON) {
+        unsigned char mask = legal_mask(w->board, me->x, me->y);
+        if (mask == 0) break;
+
+        pthread_mutex_lock(&tree_mutex);
+        unsigned char untried = 0;
+        for (int dir = 0; dir < DIRECTIONS; dir++) {
+            if ((mask & (1 << dir)) && nodes[node].children[dir] == NO_NODE) untried |= 1 << dir;
+        }
+
+        int dir = -1;
+        bool expanded = false;
+        if (untried) {
+            int child = new_node();
+            if (child != NO_NODE) {
+                dir = random_dir(w, untried);
+                nodes[node].children[dir] = child;
+                expanded = true;
+            }
+        }
+        if (dir == -1) {
+            dir = select_child(nodes, &nodes[node], mask);
+        }
+        if (dir != -1) {
+            node = nodes[node].children[dir];
+            nodes[node].visits++;
+        }
+        pthread_mutex_unlock(&tree_mutex);
+        if (dir == -1) break; // arena llena: sigue el rollout desde acá
+
+        w->path[path_length++] = node;
+        gained += step(w, dir);
+        depth++;
+        if (expanded) break;
+    }
+
+    while (depth < HORIZON) {
+        unsigned char mask = legal_mask(w->board, me->x, me->y);
+        if (mask == 0) break;
+        gained += step(w, random_dir(w, mask));
+        depth++;
+    }
+
+    double reward = gained / (9.0 * HORIZON);
+    pthread_mutex_lock(&tree_mutex);
+    for (int i = 0; i < path_length; i++) {
+        nodes[w->path[i]].total += reward;
+    }
+    pthread_mutex_unlock(&tree_mutex);
+
+    while (w->undo_count > 0) {
+        UndoEntry* entry = &w->undo[--w->undo_count];
+        w->board[entry->index] = entry->value;
+    }
+}
+
+static bool deadline_passed() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec > deadline.tv_sec || (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec);
+}
+
+static void search(Worker* w) {
+    memcpy(w->board, root_board, sizeof(cell_t) * width * height);
+    while (!deadline_passed()) {
+        simulate(w);
+    }
+}
+
+static void* worker_main(void* arg) {
+    Worker* w = arg;
+    unsigned int seen = 0;
+
+    pthread_mutex_lock(&pool_mutex);
+    while (true) {
+        while (search_round == seen && !shutting_down) {
+            pthread_cond_wait(&work_cond, &pool_mutex);
+        }
+        if (shutting_down) break;
+        seen = search_round;
+        pthread_mutex_unlock(&pool_mutex);
+
+        search(w);
+
+        pthread_mutex_lock(&pool_mutex);
+        if (--running == 0) {
+            pthread_cond_signal(&done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return NULL;
+}
+
+bool mcts_init(int w, int h, int threads) {
+    width = w;
+    height = h;
+    if (threads <= 0) {
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+        if (threads <= 0) threads = 1;
+    }
+
+    arenas[0] = malloc(sizeof(Node) * NODE_POOL);
+    arenas[1] = malloc(sizeof(Node) * NODE_POOL);
+    workers = calloc(threads, sizeof(Worker));
+    if (arenas[0] == NULL || arenas[1] == NULL || workers == NULL) {
+        return false;
+    }
+    worker_slots = threads;
+
+    uint64_t seed = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+    for (int i = 0; i < threads; i++) {
+        workers[i].board = malloc(sizeof(cell_t) * w * h);
+        if (workers[i].board == NULL) {
+            return false;
+        }
+        workers[i].rng = (seed + (i + 1) * 0x9E3779B97F4A7C15ULL) | 1;
+    }
+
+    worker_count = 1;
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) {
+            break; // se busca con los que se pudieron crear
+        }
+        worker_count++;
+    }
+    return true;
+}
+
+void mcts_free() {
+    pthread_mutex_lock(&pool_mutex);
+    shutting_down = true;
+    pthread_cond_broadcast(&work_cond);
+    pthread_mutex_unlock(&pool_mutex);
+
+    for (int i = 1; i < worker_count; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    // Los tableros se pidieron para todos, también para los hilos que no se pudieron crear
+    if (workers != NULL) {
+        for (int i = 0; i < worker_slots; i++) {
+            free(workers[i].board);
+        }
+    }
+    free(workers);
+    free(arenas[0]);
+    free(arenas[1]);
+}
+
+static int copy_subtree(const Node* from, int index, Node* to, int* count) {
+    int copy = (*count)++;
+    to[copy] = from[index];
+    for (int dir = 0; dir < DIRECTIONS; dir++) {
+        if (from[index].children[dir] != NO_NODE) {
+            to[copy].children[dir] = copy_subtree(from, from[index].children[dir], to, count);
+        }
+    }
+    return copy;
+}
+
+// Elige la raíz de este turno. Si el movimiento del turno anterior ya se aplicó, se sigue desde ese hijo;
+// si todavía no me moví (solo movieron los rivales) el árbol sigue valiendo entero, es open loop.
+static void reuse_tree(int x, int y) {
+    if (root != NO_NODE && x == last_x && y == last_y) {
+        return;
+    }
+    if (root != NO_NODE && last_dir >= 0 && x == last_x + dx[last_dir] && y == last_y + dy[last_dir]) {
+        int child = arenas[arena][root].children[last_dir];
+        if (child != NO_NODE) {
+            int count = 0;
+            root = copy_subtree(arenas[arena], child, arenas[1 - arena], &count);
+            arena = 1 - arena;
+            node_count = count;
+            return;
+        }
+    }
+    arena = 0;
+    node_count = 0;
+    root = new_node();
+}
+
+unsigned char mcts_get_movement(const cell_t* board, const SearchPlayer players[], int player_count, int me, int budget_ms) {
+    unsigned char mask = legal_mask(board, players[me].x, players[me].y);
+    if (mask == 0) return 255;
+
+    reuse_tree(players[me].x, players[me].y);
+    root_board = board;
+    memcpy(root_players, players, sizeof(SearchPlayer) * player_count);
+    root_player_count = player_count;
+    root_me = me;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += budget_ms / 1000;
+    deadline.tv_nsec += (budget_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&pool_mutex);
+    search_round++;
+    running = worker_count - 1;
+    pthread_cond_broadcast(&work_cond);
+    pthread_mutex_unlock(&pool_mutex);
+
+    search(&workers[0]);
+
+    pthread_mutex_lock(&pool_mutex);
+    while (running > 0) {
+        pthread_cond_wait(&done_cond, &pool_mutex);
+    }
+    pthread_mutex_unlock(&pool_mutex);
+
+    // El más visitado entre los legales; si no llegó a expandir nada, cualquiera legal
+    const Node* nodes = arenas[arena];
+    int best_dir = -1;
+    int best_visits = -1;
+    for (int dir = 0; dir < DIRECTIONS; dir++) {
+        if (!(mask & (1 << dir))) continue;
+        int child = nodes[root].children[dir];
+        int visits = child == NO_NODE ? 0 : nodes[child].visits;
+        if (visits > best_visits) {
+            best_visits = visits;
+            best_dir = dir;
+        }
+    }
+
+    last_x = players[me].x;
+    last_y = players[me].y;
+    last_dir = best_dir;
+    return best_dir;
+}
@@ -0,0 +1,23 @@
+// mcts.h
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <stdbool.h>
+
+#include "game_state.h"
+#include "search.h"
+
+// Búsqueda Monte Carlo en árbol (UCT) sobre los movimientos propios. Los rivales no forman parte del
+// árbol (open loop): en cada simulación juegan al azar, así el mismo árbol sirve aunque muevan distinto
+// a lo simulado y se puede reutilizar el subárbol del movimiento elegido en el turno siguiente.
+// Las simulaciones corren en un pool de hilos que comparten el árbol (un mutex y pérdida virtual).
+
+// Crea el pool de `threads` hilos de búsqueda (contando al que llama a mcts_get_movement)
+bool mcts_init(int width, int height, int threads);
+void mcts_free();
+
+// Busca durante budget_ms milisegundos desde el estado dado y devuelve la dirección más visitada,
+// o 255 si el jugador `me` no tiene movimientos.
+unsigned char mcts_get_movement(const cell_t* board, const SearchPlayer players[], int player_count, int me, int budget_ms);
+
+#endif // MCTS_H
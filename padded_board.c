@@ -0,0 +1,40 @@
+// padded_board.c
+#include <stdlib.h>
+#include <string.h>
+
+#include "padded_board.h"
+
+static void set_geometry(PaddedBoard* board, int width, int height) {
+    board->width = width;
+    board->height = height;
+    board->stride = width + 2;
+    const int offsets[DIRECTIONS] = PADDED_OFFSETS(board->stride);
+    memcpy(board->offsets, offsets, sizeof(offsets));
+}
+
+bool padded_init(PaddedBoard* board, int width, int height) {
+    set_geometry(board, width, height);
+    board->cells = calloc(padded_cell_count(width, height), sizeof(cell_t));
+    board->owns_cells = true;
+    return board->cells != NULL;
+}
+
+void padded_attach(PaddedBoard* board, cell_t* cells, int width, int height) {
+    set_geometry(board, width, height);
+    board->cells = cells;
+    board->owns_cells = false;
+    memset(cells, 0, sizeof(cell_t) * padded_cell_count(width, height));
+}
+
+void padded_free(PaddedBoard* board) {
+    if (board->owns_cells) {
+        free(board->cells);
+    }
+    board->cells = NULL;
+}
+
+void padded_load(PaddedBoard* board, const cell_t* source) {
+    for (int y = 0; y < board->height; y++) {
+        memcpy(&board->cells[padded_index(board, 0, y)], &source[y * board->width], sizeof(cell_t) * board->width);
+    }
+}
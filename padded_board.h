@@ -0,0 +1,60 @@
+// padded_board.h
+#ifndef PADDED_BOARD_H
+#define PADDED_BOARD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "game_state.h"
+
+#define DIRECTIONS 8
+
+// Desplazamiento de cada dirección: 0 arriba, 1 arriba-derecha, 2 derecha, ..., 7 arriba-izquierda
+static const int dx[DIRECTIONS] = {  0,  1, 1, 1, 0, -1, -1, -1 };
+static const int dy[DIRECTIONS] = { -1, -1, 0, 1, 1,  1,  0, -1 };
+
+// Tablero con borde: una copia privada del tablero con una fila y una columna de más de cada lado,
+// todas en 0 (ocupadas). Con eso el vecino de cualquier celda interior en la dirección dir es
+// index + offsets[dir], siempre dentro del buffer, y ver si está libre es una sola lectura, sin
+// chequear límites ni multiplicar. Los índices son del tablero con borde (padded_index).
+typedef struct {
+    int width;
+    int height;
+    int stride;                  // width + 2
+    cell_t* cells;               // (width + 2) * (height + 2) celdas
+    int offsets[DIRECTIONS];
+    bool owns_cells;             // cells se pidió en padded_init
+} PaddedBoard;
+
+// Desplazamientos de las 8 direcciones para un ancho con borde dado. Con una constante (por ejemplo
+// PADDED_OFFSETS(12) para tableros de 10 de ancho) el compilador los resuelve en tiempo de compilación.
+#define PADDED_OFFSETS(stride) \
+    { -(stride), -(stride) + 1, 1, (stride) + 1, (stride), (stride) - 1, -1, -(stride) - 1 }
+
+static inline size_t padded_cell_count(int width, int height) {
+    return (size_t)(width + 2) * (height + 2);
+}
+
+static inline int padded_index(const PaddedBoard* board, int x, int y) {
+    return (y + 1) * board->stride + x + 1;
+}
+
+// Índice con borde de la celda `linear` del tablero sin borde (y * width + x)
+static inline int padded_index_of(const PaddedBoard* board, int linear) {
+    return linear + board->stride + 1 + 2 * (linear / board->width);
+}
+
+static inline bool padded_can_move(const PaddedBoard* board, int index, unsigned char dir) {
+    return dir < DIRECTIONS && board->cells[index + board->offsets[dir]] > 0;
+}
+
+// Pide el buffer (todo en 0). Devuelve false si no hubo memoria.
+bool padded_init(PaddedBoard* board, int width, int height);
+// Usa `cells` (padded_cell_count celdas) en lugar de pedir memoria, y lo deja todo en 0
+void padded_attach(PaddedBoard* board, cell_t* cells, int width, int height);
+void padded_free(PaddedBoard* board);
+
+// Copia el tablero sin borde fila por fila; el borde no se toca y sigue en 0
+void padded_load(PaddedBoard* board, const cell_t* source);
+
+#endif // PADDED_BOARD_H
@@ -12,12 +12,20 @@
 #include <poll.h> // Incluir para usar poll()
 #include <string.h>
 #include <limits.h>
+#include "bitboard.h"
+#include "region.h"
+#include "mcts.h"
+#include "alphabeta.h"
+#include "game_ext.h"
+#include "game_rules.h"
+#include "telemetry.h"
 
 // #define DEBUG
 
 int width = 0;
 int height = 0;
-int* board = NULL;
+cell_t* board = NULL;
+PaddedBoard padded; // la misma copia del tablero con borde, para validar y para el flood fill sin chequear límites
 int my_id = -1;
 int my_x = -1;
 int my_y = -1;
@@ -28,51 +36,7 @@ int error_sending_move = 0;
 unsigned char last_dir = 0;
 
 bool is_valid_movement(unsigned char dir) {
-    int new_x = my_x;
-    int new_y = my_y;
-
-    // Calcular nueva posición según la dirección
-    switch (dir) {
-        case 0: new_y--; break;          // Arriba
-        case 1: new_x++; new_y--; break; // Arriba-Derecha
-        case 2: new_x++; break;          // Derecha
-        case 3: new_x++; new_y++; break; // Abajo-Derecha
-        case 4: new_y++; break;          // Abajo
-        case 5: new_x--; new_y++; break; // Abajo-Izquierda
-        case 6: new_x--; break;          // Izquierda
-        case 7: new_x--; new_y--; break; // Arriba-Izquierda
-        default: return false;             // Dirección inválida
-    }
-
-    // Verificar límites del tablero
-    if (new_x < 0 || new_x >= width || new_y < 0 || new_y >= height) {
-        #ifdef DEBUG
-            fprintf(stderr, "[player] Movimiento fuera de límites: (%d, %d) -> (%d, %d)\n", my_x, my_y, new_x, new_y);
-        #endif
-
-        return false;
-    }
-
-    // Verificar si la celda está ocupada
-    int index = new_y * width + new_x;
-    if (board[index] <= 0) {
-        #ifdef DEBUG
-            fprintf(stderr, "[game_state] Jugador %d en (%d, %d) moviéndose a (%d, %d)\n", my_id, my_x, my_y, new_x, new_y);
-            // Print all the squares in the area (9 squares)
-            for (int i = -1; i <= 1; i++) {
-                for (int j = -1; j <= 1; j++) {
-                    int new_index = (my_y + i) * width + (my_x + j);
-                    if (new_index >= 0 && new_index < width * height) {
-                        fprintf(stderr, "[game_state] Celda (%d, %d): %d\n", my_y + j, my_y + i, board[new_index]);
-                    }
-                }
-            }
-        #endif
-
-        return false;
-    }
-
-    return true;
+    return padded_can_move(&padded, padded_index(&padded, my_x, my_y), dir);
 }
 
 unsigned char get_first_valid_movement() {
@@ -94,78 +58,80 @@ unsigned char get_random_movement() {
     return dir;
 }
 
-#define DIRECTIONS 8
-#define MAX_DEPTH 1000
+// Orden en el que se evalúan los vecinos. Es el mismo que recorría la versión con un BFS
+// por dirección, así los empates se siguen resolviendo igual.
+const unsigned char eval_order[DIRECTIONS] = { 2, 5, 0, 3, 6, 1, 4, 7 };
 
-const int dx[DIRECTIONS] = {  0,  1, 1, 1, 0, -1, -1, -1 };
-const int dy[DIRECTIONS] = { -1, -1, 0, 1, 1,  1,  0, -1 };
+// Algoritmo GOD, bah maomeno, no es mucho pero es trabajo honesto
+// Cada dirección vale lo que suma la región libre a la que lleva. La evaluación vive en region.c
+// para que la puedan usar también los plugins que corren dentro del máster.
+RegionEvaluator regions;
 
-int in_range(int x, int y, int w, int h) {
-    return x >= 0 && y >= 0 && x < w && y < h;
+unsigned char ia_god_get_movement(int my_x, int my_y) {
+    return region_best_move_padded(&regions, &padded, my_x, my_y);
 }
 
-int reward_at(int* board, int x, int y, int w, int h) {
-    if (!in_range(x, y, w, h)) return 0;
-    int val = board[y * w + x];
-    return val > 0 ? val : 0;
-}
 
-bool is_free(int* board, int x, int y, int w, int h) {
-    return in_range(x, y, w, h) && board[y * w + x] > 0;
-}
+// Misma evaluación que ia_god_get_movement pero sobre el tablero empaquetado:
+// el flood fill y la suma de recompensas procesan 64 celdas por operación
+Bitboard free_cells;
+Bitboard value_planes[BB_PLANES];
+Bitboard region_boards[DIRECTIONS];
+bool bitboards_loaded = false; // free_cells y value_planes corresponden a `board` (update_board los pone al día)
 
-int bfs(int* board, GameState* state, int* visited, int x, int y, int w, int h, int depth, int my_id, int accumulated) {
-    int max_score = accumulated;
-    int queue[w * h][3];
-    int front = 0, rear = 0;
-
-    queue[rear][0] = x;
-    queue[rear][1] = y;
-    queue[rear][2] = depth;
-    rear++;
-    visited[y * w + x] = 1;
-
-    while (front < rear) {
-        int cx = queue[front][0];
-        int cy = queue[front][1];
-        int current_depth = queue[front][2];
-        front++;
-
-        max_score += reward_at(board, cx, cy, w, h);
-
-        if (current_depth <= 0) continue;
-
-        for (int i = 0; i < DIRECTIONS; i++) {
-            int nx = cx + dx[i];
-            int ny = cy + dy[i];
-            if (is_free(board, nx, ny, w, h) && !visited[ny * w + nx]) {
-                visited[ny * w + nx] = 1;
-                queue[rear][0] = nx;
-                queue[rear][1] = ny;
-                queue[rear][2] = current_depth - 1;
-                rear++;
-            }
-        }
+bool init_bitboards(int w, int h) {
+    bool ok = bb_init(&free_cells, w, h);
+    for (int k = 0; k < BB_PLANES; k++) {
+        ok = bb_init(&value_planes[k], w, h) && ok;
     }
-
-    return max_score;
+    for (int i = 0; i < DIRECTIONS; i++) {
+        ok = bb_init(&region_boards[i], w, h) && ok;
+    }
+    return ok;
 }
 
+void free_bitboards() {
+    bb_free(&free_cells);
+    for (int k = 0; k < BB_PLANES; k++) {
+        bb_free(&value_planes[k]);
+    }
+    for (int i = 0; i < DIRECTIONS; i++) {
+        bb_free(&region_boards[i]);
+    }
+}
 
-// Algoritmo GOD, bah maomeno, no es mucho pero es trabajo honesto
-unsigned char ia_god_get_movement(GameState* state, int* board, int my_id, int my_x, int my_y, int w, int h) {
+unsigned char ia_god_bitboard_get_movement(cell_t* board, int my_x, int my_y) {
     int best_score = INT_MIN;
     unsigned char best_dir = 255;
 
-    for (unsigned char dir = 0; dir < DIRECTIONS; dir++) {
-        dir = (dir + 2) % 8; 
+    int region_score[DIRECTIONS];
+    int regions = 0;
+
+    // Se arman enteros solo la primera vez o después de una copia entera del tablero
+    if (!bitboards_loaded) {
+        bb_load_board(&free_cells, value_planes, board);
+        bitboards_loaded = true;
+    }
+    unsigned char free_mask = bb_free_neighbours(&free_cells, my_x, my_y);
+
+    for (int i = 0; i < DIRECTIONS; i++) {
+        unsigned char dir = eval_order[i];
+        if (!(free_mask & (1 << dir))) continue;
+
         int nx = my_x + dx[dir];
         int ny = my_y + dy[dir];
-        if (!is_free(board, nx, ny, w, h)) continue;
 
-        int visited[w * h];
-        memset(visited, 0, sizeof(visited));
-        int score = bfs(board, state, visited, nx, ny, w, h, MAX_DEPTH, my_id, 0);
+        // Si el vecino cae en una región ya calculada se reutiliza
+        int region = 0;
+        while (region < regions && !bb_get(&region_boards[region], nx, ny)) {
+            region++;
+        }
+        if (region == regions) {
+            bb_flood(&region_boards[region], &free_cells, nx, ny);
+            region_score[region] = bb_weighted_count(&region_boards[region], value_planes);
+            regions++;
+        }
+        int score = region_score[region];
 
         if (score > best_score) {
             best_score = score;
@@ -176,6 +142,156 @@ unsigned char ia_god_get_movement(GameState* state, int* board, int my_id, int m
 }
 
 
+// Estrategia del jugador, se elige con la variable de entorno PLAYER_STRATEGY
+typedef enum {
+    STRATEGY_GOD,       // "god" (default): regiones con flood fill celda por celda
+    STRATEGY_BITBOARD,  // "bitboard": misma evaluación sobre el tablero empaquetado
+    STRATEGY_FIRST,     // "first": primer movimiento válido
+    STRATEGY_RANDOM,    // "random": movimiento válido al azar
+    STRATEGY_MCTS,      // "mcts": Monte Carlo en árbol con un pool de hilos y tiempo por jugada
+    STRATEGY_ALPHABETA, // "alphabeta": minimax contra el rival más cercano, territorio de Voronoi y tabla de transposición
+} Strategy;
+
+Strategy strategy = STRATEGY_GOD;
+
+// Para mcts y alphabeta: tiempo de búsqueda por jugada (PLAYER_BUDGET_MS); mcts además usa
+// PLAYER_THREADS hilos (default: uno por núcleo). El presupuesto tiene que quedar bien por debajo del timeout del máster.
+#define BUDGET_MS_DEFAULT 50
+int budget_ms = BUDGET_MS_DEFAULT;
+int search_threads = 0;
+
+// Posiciones de todos los jugadores, copiadas junto con el tablero (mcts simula también a los rivales)
+SearchPlayer players[MAX_PLAYERS];
+int players_count = 0;
+
+int env_int(const char* name, int default_value) {
+    const char* value = getenv(name);
+    if (value == NULL) return default_value;
+    int parsed = atoi(value);
+    return parsed > 0 ? parsed : default_value;
+}
+
+void select_strategy() {
+    const char* name = getenv("PLAYER_STRATEGY");
+    if (name == NULL || strcmp(name, "god") == 0) {
+        strategy = STRATEGY_GOD;
+    } else if (strcmp(name, "bitboard") == 0) {
+        strategy = STRATEGY_BITBOARD;
+    } else if (strcmp(name, "first") == 0) {
+        strategy = STRATEGY_FIRST;
+    } else if (strcmp(name, "random") == 0) {
+        strategy = STRATEGY_RANDOM;
+    } else if (strcmp(name, "mcts") == 0) {
+        strategy = STRATEGY_MCTS;
+        budget_ms = env_int("PLAYER_BUDGET_MS", BUDGET_MS_DEFAULT);
+        search_threads = env_int("PLAYER_THREADS", 0);
+    } else if (strcmp(name, "alphabeta") == 0) {
+        strategy = STRATEGY_ALPHABETA;
+        budget_ms = env_int("PLAYER_BUDGET_MS", BUDGET_MS_DEFAULT);
+    } else {
+        fprintf(stderr, "[player] Estrategia desconocida: %s, se usa god\n", name);
+        strategy = STRATEGY_GOD;
+    }
+}
+
+unsigned char get_movement() {
+    switch (strategy) {
+        case STRATEGY_BITBOARD: return ia_god_bitboard_get_movement(board, my_x, my_y);
+        case STRATEGY_FIRST: return get_first_valid_movement();
+        case STRATEGY_RANDOM: return get_random_movement();
+        case STRATEGY_MCTS: return mcts_get_movement(board, players, players_count, my_id, budget_ms);
+        case STRATEGY_ALPHABETA: return alphabeta_get_movement(board, players, players_count, my_id, budget_ms);
+        case STRATEGY_GOD:
+        default: return ia_god_get_movement(my_x, my_y); // <-- La que "mejor funciona"
+    }
+}
+
+
+#define WAIT_TIMEOUT_MS 1000 // por si el máster muere sin avisar
+
+// Copia local del tablero al día hasta el movimiento board_seq de la bitácora del máster
+GameExt* ext = NULL;
+Telemetry* telemetry = NULL; // si el máster corre con --telemetry
+bool board_loaded = false;
+unsigned int board_seq = 0;
+
+// --sync buffers: copias publicadas del estado (ver SYNC_BUFFERED en game_ext.h)
+void* buffers = NULL;
+size_t buffer_stride = 0;
+
+// Hasta dónde llega la bitácora en el estado en vivo; se lee dentro de la sección de lectura
+unsigned int live_journal_head() {
+    return ext != NULL ? __atomic_load_n(&ext->journal_head, __ATOMIC_ACQUIRE) : 0;
+}
+
+// Pone al día la copia local del tablero hasta el movimiento `head` de la bitácora, que es hasta donde
+// llega el estado que se está copiando. Si el máster publica la bitácora se aplican solo los movimientos
+// nuevos (una celda cada uno); si no la hay, es la primera lectura o nos atrasamos más que el buffer,
+// se copia entero.
+unsigned int update_board(GameState* game_state, unsigned int head) {
+    if (ext == NULL) {
+        memcpy(board, game_state->board, sizeof(cell_t) * width * height);
+        padded_load(&padded, board);
+        bitboards_loaded = false;
+        return 0;
+    }
+
+    if (board_loaded && head - board_seq <= JOURNAL_SIZE) {
+        JournalEntry entry;
+        unsigned int seq = board_seq;
+        while (seq != head && ext_journal_read(ext, seq + 1, &entry)) {
+            board[entry.to] = -entry.player_id;
+            padded.cells[padded_index_of(&padded, entry.to)] = -entry.player_id;
+            if (bitboards_loaded) bb_take_cell(&free_cells, value_planes, entry.to);
+            seq++;
+        }
+        if (seq == head) {
+            return head;
+        }
+    }
+
+    memcpy(board, game_state->board, sizeof(cell_t) * width * height);
+    padded_load(&padded, board);
+    bitboards_loaded = false;
+    return head;
+}
+
+// Copia lo que el player necesita del estado compartido. Se llama dentro de la sección de lectura
+// (lightswitch o seqlock), así que con seqlock puede repetirse: el tablero (con sus bitboards) y las
+// posiciones de los jugadores se pisan enteros en cada intento, y my_id se fija una sola vez, cuando
+// aparece mi pid. Eso sí vale aunque la copia quede a medias: el máster escribe cada pid una sola vez,
+// antes de que empiece el juego, y ningún otro lugar de la lista puede tener el mío.
+// `head` es hasta dónde llega la bitácora en ese estado; queda en `seq`.
+// Devuelve false si todavía no aparece mi pid en la lista de jugadores.
+bool copy_game_state(GameState* game_state, unsigned int head, int* x, int* y, bool* blocked, unsigned int* seq) {
+    // buscar mi id
+    if (my_id == -1) {
+        for (int i = 0; i < game_state->player_count && i < MAX_PLAYERS; i++) {
+            if (game_state->players[i].pid == getpid()) {
+                my_id = i;
+                break;
+            }
+        }
+        if (my_id == -1) return false;
+    }
+
+    // traer el tablero al día
+    *seq = update_board(game_state, head);
+
+    players_count = game_state->player_count < MAX_PLAYERS ? game_state->player_count : MAX_PLAYERS;
+    for (int i = 0; i < players_count; i++) {
+        players[i].x = game_state->players[i].x;
+        players[i].y = game_state->players[i].y;
+        players[i].blocked = game_state->players[i].is_blocked;
+    }
+
+    *blocked = game_state->players[my_id].is_blocked;
+    *x = game_state->players[my_id].x;
+    *y = game_state->players[my_id].y;
+    return true;
+}
+
+
 int main(int argc, char* argv[]) {
     if (argc < 3) {
         fprintf(stderr, "Uso: %s ancho alto\n", argv[0]);
@@ -185,15 +301,43 @@ int main(int argc, char* argv[]) {
     width = atoi(argv[1]);
     height = atoi(argv[2]);
 
-    int shm_fd = shm_open(SHM_STATE, O_RDONLY, 0);
+    // Si el máster corre con namespace, los nombres llevan el sufijo de GAME_NS
+    char state_name[NS_NAME_MAX], sync_name[NS_NAME_MAX];
+    ns_name(state_name, sizeof(state_name), SHM_STATE);
+    ns_name(sync_name, sizeof(sync_name), SHM_SYNC);
+
+    int shm_fd = shm_open(state_name, O_RDONLY, 0);
     if (shm_fd < 0) {
         perror("[player] shm_open state");
         return 1;
     }
-    int size = sizeof(GameState) + sizeof(int) * width * height;
+    // Si el máster publica el segmento de extensiones puede pedir leer con seqlock en lugar del lightswitch
+    // y preparar el mapeo del estado (--prefault, --hugepages)
+    ext = ext_attach(sizeof(cell_t));
+    if (ext != NULL) {
+        ext_enable_move_messages(ext); // desde acá cada movimiento va como MoveMessage
+    }
+    unsigned int map_flags = ext != NULL ? ext->map_flags : 0;
+    telemetry = telemetry_attach();
+
+    size_t size = ext_state_map_size(sizeof(GameState) + sizeof(cell_t) * width * height, map_flags);
     GameState* game_state = mmap(NULL, size, PROT_READ, MAP_SHARED, shm_fd, 0);
+    if (game_state == MAP_FAILED) {
+        perror("[player] mmap state");
+        return 1;
+    }
+    ext_prepare_mapping(game_state, size, map_flags);
+
+    if (ext != NULL && ext->sync_mode == SYNC_BUFFERED) {
+        buffer_stride = ext_buffer_stride(sizeof(GameState) + sizeof(cell_t) * width * height);
+        buffers = ext_buffers_attach(ext, buffer_stride);
+        if (buffers == NULL) {
+            perror("[player] mmap buffers");
+            return 1;
+        }
+    }
 
-    int shm_sync_fd = shm_open(SHM_SYNC, O_RDWR, 0);
+    int shm_sync_fd = shm_open(sync_name, O_RDWR, 0);
     if (shm_sync_fd < 0) {
         perror("[player] shm_open sync");
         return 1;
@@ -203,63 +347,151 @@ int main(int argc, char* argv[]) {
     srand(getpid()); // Semilla para el generador de números aleatorios que no usamos lol
 
     // Inicializar el tablero
-    board = malloc(sizeof(int) * width * height);
-    if (board == NULL) {
+    board = malloc(sizeof(cell_t) * width * height);
+    if (board == NULL || !padded_init(&padded, width, height)) {
         fprintf(stderr, "[player] Error al asignar memoria para el tablero\n");
         exit(1);
     }
+    if (!region_init(&regions, width, height)) {
+        fprintf(stderr, "[player] Error al asignar memoria para el evaluador de regiones\n");
+        exit(1);
+    }
 
-    // buscar mi id
-    for (int i = 0; i < game_state->player_count; i++) {
-        if (game_state->players[i].pid == getpid()) {
-            my_id = i;
-            break;
-        }
+    select_strategy();
+    if (strategy == STRATEGY_BITBOARD && !init_bitboards(width, height)) {
+        fprintf(stderr, "[player] Error al asignar memoria para los bitboards\n");
+        exit(1);
+    }
+    if (strategy == STRATEGY_MCTS && !mcts_init(width, height, search_threads)) {
+        fprintf(stderr, "[player] Error al asignar memoria para la búsqueda\n");
+        exit(1);
+    }
+    if (strategy == STRATEGY_ALPHABETA && !alphabeta_init(width, height)) {
+        fprintf(stderr, "[player] Error al asignar memoria para la búsqueda\n");
+        exit(1);
+    }
+
+    // La copia privada del tablero también se recorre entera en el primer turno
+    ext_prepare_mapping(board, sizeof(cell_t) * width * height, map_flags & EXT_PREFAULT);
+    ext_prepare_mapping(padded.cells, sizeof(cell_t) * padded_cell_count(width, height), map_flags & EXT_PREFAULT);
+    if (map_flags & EXT_PREFAULT) {
+        ext_signal_ready(ext);
     }
 
+    bool use_seqlock = ext != NULL && ext->sync_mode == SYNC_SEQLOCK;
+    bool use_buffers = ext != NULL && ext->sync_mode == SYNC_BUFFERED;
+
+    // Con el segmento de extensiones no hace falta girar: después de decidir con un estado
+    // se duerme hasta que el máster publique el siguiente
+    bool state_processed = false;
+    unsigned int generation = 0;
+
     while (!game_state->is_finished) {
-        // anti-inanición
-        sem_wait(&sync->starvation_mutex);
-        sem_post(&sync->starvation_mutex);
-        
-        // lightswitch enter
-        sem_wait(&sync->reader_count_mutex);
-        sync->reader_count++;
-        if (sync->reader_count == 1) {
-            sem_wait(&sync->game_state_mutex);
+        int new_x, new_y;
+        bool blocked;
+        bool found;
+        unsigned int seq_read;
+        unsigned int version;
+        uint64_t publish_ns = 0;   // publicación del estado que se leyó, para el tiempo de reacción
+        uint64_t wait_ns = 0, enter_ns = 0;
+        unsigned int retries = 0;
+
+        if (ext != NULL) {
+            if (state_processed) {
+                ext_wait_generation(ext, generation, WAIT_TIMEOUT_MS);
+            }
+            generation = ext_generation(ext);
+            state_processed = true;
         }
-        sem_post(&sync->reader_count_mutex);
 
-        // copiar el tablero nuevo
-        memcpy(board, game_state->board, sizeof(int) * width * height);
+        if (use_seqlock) {
+            // lectura optimista: si el máster escribió mientras copiábamos, se repite
+            unsigned int seq;
+            bool retry;
+            do {
+                seq = ext_read_begin(ext);
+                if (telemetry) publish_ns = __atomic_load_n(&telemetry->last_publish_ns, __ATOMIC_RELAXED);
+                version = ext_version(ext);
+                found = copy_game_state(game_state, live_journal_head(), &new_x, &new_y, &blocked, &seq_read);
+                retry = ext_read_retry(ext, seq);
+                if (retry) retries++;
+            } while (retry);
+        } else if (use_buffers) {
+            // se copia la última copia publicada: mientras la tenemos anotada el máster no la toca
+            if (telemetry) publish_ns = __atomic_load_n(&telemetry->last_publish_ns, __ATOMIC_RELAXED);
+            unsigned int index = ext_buffer_acquire(ext, &retries);
+            if (telemetry) enter_ns = telemetry_now_ns();
+            version = ext->buffer_version[index];
+            found = copy_game_state(ext_buffer(buffers, buffer_stride, index), ext->buffer_journal[index],
+                                    &new_x, &new_y, &blocked, &seq_read);
+            ext_buffer_release(ext, index);
+            if (telemetry && found) {
+                telemetry_record(&telemetry->players[my_id].read_hold, telemetry_now_ns() - enter_ns);
+            }
+        } else {
+            if (telemetry) wait_ns = telemetry_now_ns();
+
+            // anti-inanición
+            sem_wait(&sync->starvation_mutex);
+            sem_post(&sync->starvation_mutex);
 
-        is_player_blocked = game_state->players[my_id].is_blocked;
+            // lightswitch enter
+            sem_wait(&sync->reader_count_mutex);
+            sync->reader_count++;
+            if (sync->reader_count == 1) {
+                sem_wait(&sync->game_state_mutex);
+            }
+            sem_post(&sync->reader_count_mutex);
+
+            if (telemetry) {
+                enter_ns = telemetry_now_ns();
+                publish_ns = __atomic_load_n(&telemetry->last_publish_ns, __ATOMIC_RELAXED);
+            }
+            version = ext != NULL ? ext_version(ext) : 0;
+            found = copy_game_state(game_state, live_journal_head(), &new_x, &new_y, &blocked, &seq_read);
+
+            // lightswitch exit (fin lectura)
+            sem_wait(&sync->reader_count_mutex);
+            sync->reader_count--;
+            if (sync->reader_count == 0) {
+                sem_post(&sync->game_state_mutex);
+            }
+            sem_post(&sync->reader_count_mutex);
+
+            if (telemetry && found) {
+                PlayerTelemetry* mine = &telemetry->players[my_id];
+                telemetry_record(&mine->read_wait, enter_ns - wait_ns);
+                telemetry_record(&mine->read_hold, telemetry_now_ns() - enter_ns);
+            }
+        }
+        if (telemetry && found) {
+            telemetry_count(&telemetry->players[my_id].reads, 1);
+            telemetry_count(&telemetry->players[my_id].read_retries, retries);
+        }
+
+        if (!found) {
+            continue; // el máster todavía no publicó mi pid
+        }
+        board_loaded = true;
+        board_seq = seq_read;
+
+        is_player_blocked = blocked;
 
         // para después no moverse si no cambié de posición
-        if (my_x == game_state->players[my_id].x && my_y == game_state->players[my_id].y) {
+        if (my_x == new_x && my_y == new_y) {
             was_player_moved = 0;
         } else {
             was_player_moved = 1;
         }
-        
-        my_x = game_state->players[my_id].x;
-        my_y = game_state->players[my_id].y;
-            
-        // lightswitch exit (fin lectura)
-        sem_wait(&sync->reader_count_mutex);
-        sync->reader_count--;
-        if (sync->reader_count == 0) {
-            sem_post(&sync->game_state_mutex);
-        }
-        sem_post(&sync->reader_count_mutex);
-        
-        
+
+        my_x = new_x;
+        my_y = new_y;
+
         if (is_player_blocked) {
             break;
         }
 
-        unsigned char dir = ia_god_get_movement(game_state, board, my_id, my_x, my_y, width, height); // <-- La que "mejor funciona"
-        // unsigned char dir = get_first_valid_movement();  // <-- Otra opción de player que sea random
+        unsigned char dir = get_movement();
         
         // Evita pedir moverse si no ha cambiado de posición
         // A menos que me ganaron el movimiento, por ende cambió la dirección
@@ -285,8 +517,14 @@ int main(int argc, char* argv[]) {
             continue;
         }
 
-        // Enviar movimiento al pipe
-        ret = write(STDOUT_FILENO, &dir, 1);
+        // Enviar movimiento al pipe. Con el máster del TP va con la versión del estado con que se decidió y
+        // reemplaza al anterior si el máster todavía no lo aplicó (por ejemplo porque otro me ganó la celda).
+        if (ext != NULL) {
+            MoveMessage message = { .marker = MOVE_MSG_MARKER, .dir = dir, .flags = MOVE_REPLACE, .version = version };
+            ret = write(STDOUT_FILENO, &message, sizeof(message));
+        } else {
+            ret = write(STDOUT_FILENO, &dir, 1);
+        }
         if (ret == -1) {
             #ifdef DEBUG
                 fprintf(stderr, "[player] Pipe lleno, no se puede escribir ahora\n");
@@ -296,12 +534,24 @@ int main(int argc, char* argv[]) {
             continue;
         }
         last_dir = dir;
+        if (telemetry) {
+            telemetry_record(&telemetry->players[my_id].reaction, telemetry_now_ns() - publish_ns);
+            telemetry_count(&telemetry->players[my_id].moves_sent, 1);
+        }
 
         
         // usleep(1000 * 1000);
     }
 
     free(board);
+    padded_free(&padded);
+    ext_buffers_detach(buffers, ext, buffer_stride);
+    ext_detach(ext);
+    telemetry_detach(telemetry);
+    region_free(&regions);
+    if (strategy == STRATEGY_BITBOARD) free_bitboards();
+    if (strategy == STRATEGY_MCTS) mcts_free();
+    if (strategy == STRATEGY_ALPHABETA) alphabeta_free();
     
     #ifdef DEBUG
         fprintf(stderr, "[player] Terminado\n");
@@ -0,0 +1,32 @@
+// player_plugin.h
+#ifndef PLAYER_PLUGIN_H
+#define PLAYER_PLUGIN_H
+
+#include <stdbool.h>
+
+#include "game_state.h"
+
+// Interfaz de los players que corren dentro del máster como bibliotecas compartidas (-p estrategia.so).
+// El máster carga la biblioteca con dlopen y corre cada jugador en su propio hilo, con acceso directo
+// al estado: no hay fork, FIFO ni semáforos por movimiento.
+//
+// Obligatoria:
+//   int choose_move(const GameState* state, int id);
+//     Devuelve la dirección (0 a 7, mismas que el protocolo) o un número negativo para dejar de jugar.
+//     Se llama con el estado tomado para lectura: el máster no lo modifica hasta que vuelve.
+//     No se llama si el jugador ya está bloqueado.
+// Opcionales:
+//   bool plugin_init(int width, int height, int id); // antes de la primera jugada, false = no juega
+//   void plugin_fini(int id);                         // al terminar la partida
+//
+// Si se carga la misma biblioteca para varios jugadores se comparte una sola copia y cada jugador
+// llama desde su hilo: lo que la estrategia guarde entre jugadas tiene que estar separado por id.
+#define PLUGIN_CHOOSE_MOVE "choose_move"
+#define PLUGIN_INIT "plugin_init"
+#define PLUGIN_FINI "plugin_fini"
+
+typedef int (*plugin_choose_move_fn)(const GameState* state, int id);
+typedef bool (*plugin_init_fn)(int width, int height, int id);
+typedef void (*plugin_fini_fn)(int id);
+
+#endif // PLAYER_PLUGIN_H
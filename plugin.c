@@ -0,0 +1,186 @@
+// plugin.c
+#define _GNU_SOURCE // pthread_rwlockattr_setkind_np
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "plugin.h"
+
+#define PLUGIN_WAIT_TIMEOUT_MS 1000 // por si se pierde un aviso, igual que los players comunes
+#define PLUGIN_PATH_MAX 4096
+
+struct PluginPlayer {
+    int id;
+    void* handle;
+    plugin_choose_move_fn choose_move;
+    plugin_fini_fn fini;
+    pthread_t thread;
+    int event_fd;
+    int mailbox; // PLUGIN_NO_MOVE o el movimiento que el máster todavía no tomó
+    const GameState* state;
+    GameExt* ext;
+    Telemetry* telemetry;
+};
+
+// Con preferencia de escritor: si no, con varios hilos leyendo todo el tiempo el máster podría no entrar nunca
+static pthread_rwlock_t state_lock;
+static pthread_once_t state_lock_once = PTHREAD_ONCE_INIT;
+
+static void init_state_lock() {
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(&state_lock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+}
+
+void plugin_state_lock() {
+    pthread_once(&state_lock_once, init_state_lock);
+    pthread_rwlock_wrlock(&state_lock);
+}
+
+void plugin_state_unlock() {
+    pthread_rwlock_unlock(&state_lock);
+}
+
+bool plugin_is_path(const char* path) {
+    size_t len = strlen(path);
+    return len > 3 && strcmp(path + len - 3, ".so") == 0;
+}
+
+// Igual que un player común: se lee la generación, se decide con el estado y se duerme hasta la siguiente.
+// Mientras el máster no tome el movimiento anterior no se decide otro, así no se encolan jugadas viejas.
+static void* plugin_thread(void* arg) {
+    PluginPlayer* plugin = arg;
+    const GameState* state = plugin->state;
+
+    while (true) {
+        unsigned int generation = ext_generation(plugin->ext);
+        bool mailbox_empty = __atomic_load_n(&plugin->mailbox, __ATOMIC_ACQUIRE) == PLUGIN_NO_MOVE;
+        int move = PLUGIN_NO_MOVE;
+        uint64_t publish_ns = 0;
+
+        pthread_rwlock_rdlock(&state_lock);
+        if (plugin->telemetry) {
+            publish_ns = __atomic_load_n(&plugin->telemetry->last_publish_ns, __ATOMIC_RELAXED);
+            telemetry_count(&plugin->telemetry->players[plugin->id].reads, 1);
+        }
+        bool finished = state->is_finished;
+        if (!finished && mailbox_empty) {
+            if (state->players[plugin->id].is_blocked) {
+                move = PLUGIN_DONE;
+            } else {
+                move = plugin->choose_move(state, plugin->id);
+                if (move < 0) move = PLUGIN_DONE;
+            }
+        }
+        pthread_rwlock_unlock(&state_lock);
+
+        if (finished) break;
+
+        if (move != PLUGIN_NO_MOVE) {
+            __atomic_store_n(&plugin->mailbox, move, __ATOMIC_RELEASE);
+            uint64_t one = 1;
+            if (write(plugin->event_fd, &one, sizeof(one)) == -1) {
+                perror("write eventfd plugin");
+            }
+            if (move == PLUGIN_DONE) break;
+            if (plugin->telemetry) {
+                PlayerTelemetry* mine = &plugin->telemetry->players[plugin->id];
+                telemetry_record(&mine->reaction, telemetry_now_ns() - publish_ns);
+                telemetry_count(&mine->moves_sent, 1);
+            }
+        }
+        ext_wait_generation(plugin->ext, generation, PLUGIN_WAIT_TIMEOUT_MS);
+    }
+    return NULL;
+}
+
+PluginPlayer* plugin_start(const char* path, int id, const GameState* state, GameExt* ext, Telemetry* telemetry) {
+    pthread_once(&state_lock_once, init_state_lock);
+
+    PluginPlayer* plugin = calloc(1, sizeof(PluginPlayer));
+    if (plugin == NULL) {
+        perror("calloc plugin");
+        return NULL;
+    }
+    plugin->id = id;
+    plugin->state = state;
+    plugin->ext = ext;
+    plugin->telemetry = telemetry;
+    plugin->mailbox = PLUGIN_NO_MOVE;
+    plugin->event_fd = -1;
+
+    // Sin barra dlopen busca en las rutas de bibliotecas del sistema, como execl se toma relativo al directorio actual
+    char full_path[PLUGIN_PATH_MAX];
+    snprintf(full_path, sizeof(full_path), "%s%s", strchr(path, '/') ? "" : "./", path);
+    plugin->handle = dlopen(full_path, RTLD_NOW | RTLD_LOCAL);
+    if (plugin->handle == NULL) {
+        fprintf(stderr, "dlopen plugin: %s\n", dlerror());
+        free(plugin);
+        return NULL;
+    }
+
+    plugin->choose_move = (plugin_choose_move_fn)dlsym(plugin->handle, PLUGIN_CHOOSE_MOVE);
+    plugin_init_fn init = (plugin_init_fn)dlsym(plugin->handle, PLUGIN_INIT);
+    plugin->fini = (plugin_fini_fn)dlsym(plugin->handle, PLUGIN_FINI);
+    if (plugin->choose_move == NULL) {
+        fprintf(stderr, "El plugin %s no exporta %s\n", path, PLUGIN_CHOOSE_MOVE);
+        dlclose(plugin->handle);
+        free(plugin);
+        return NULL;
+    }
+    if (init != NULL && !init(state->width, state->height, id)) {
+        fprintf(stderr, "El plugin %s no se pudo inicializar\n", path);
+        dlclose(plugin->handle);
+        free(plugin);
+        return NULL;
+    }
+
+    plugin->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (plugin->event_fd == -1) {
+        perror("eventfd plugin");
+        if (plugin->fini != NULL) plugin->fini(id);
+        dlclose(plugin->handle);
+        free(plugin);
+        return NULL;
+    }
+
+    int error = pthread_create(&plugin->thread, NULL, plugin_thread, plugin);
+    if (error != 0) {
+        fprintf(stderr, "pthread_create plugin: %s\n", strerror(error));
+        close(plugin->event_fd);
+        if (plugin->fini != NULL) plugin->fini(id);
+        dlclose(plugin->handle);
+        free(plugin);
+        return NULL;
+    }
+    return plugin;
+}
+
+int plugin_event_fd(const PluginPlayer* plugin) {
+    return plugin->event_fd;
+}
+
+int plugin_take_move(PluginPlayer* plugin) {
+    uint64_t count;
+    // EAGAIN: el aviso ya se consumió junto con uno anterior, igual se mira el buzón
+    if (read(plugin->event_fd, &count, sizeof(count)) == -1 && errno != EAGAIN) {
+        perror("read eventfd plugin");
+    }
+    return __atomic_exchange_n(&plugin->mailbox, PLUGIN_NO_MOVE, __ATOMIC_ACQ_REL);
+}
+
+void plugin_join(PluginPlayer* plugin) {
+    pthread_join(plugin->thread, NULL);
+    if (plugin->fini != NULL) plugin->fini(plugin->id);
+    close(plugin->event_fd);
+    dlclose(plugin->handle);
+    free(plugin);
+}
@@ -0,0 +1,42 @@
+// plugin.h
+#ifndef PLUGIN_H
+#define PLUGIN_H
+
+#include <stdbool.h>
+
+#include "game_state.h"
+#include "game_ext.h"
+#include "player_plugin.h"
+#include "telemetry.h"
+
+// Lado del máster de los players en proceso (ver player_plugin.h): cada uno corre en un hilo y entrega
+// sus movimientos por un buzón de un lugar, avisando por un eventfd que el máster registra en su epoll
+// igual que los pipes de los players comunes.
+typedef struct PluginPlayer PluginPlayer;
+
+#define PLUGIN_NO_MOVE -1 // el buzón estaba vacío
+#define PLUGIN_DONE -2    // el jugador dejó de jugar (como un EOF en el pipe)
+
+// Un -p que termina en .so se carga como plugin en lugar de ejecutarse
+bool plugin_is_path(const char* path);
+
+// Carga la biblioteca y crea el hilo del jugador `id`. El hilo no lee el estado hasta que el máster
+// lo libera con plugin_state_unlock. Devuelve NULL (y avisa por stderr) si no se pudo cargar.
+// Con telemetry (puede ser NULL) el hilo registra su tiempo de reacción como un player común.
+PluginPlayer* plugin_start(const char* path, int id, const GameState* state, GameExt* ext, Telemetry* telemetry);
+
+// Descriptor que se vuelve legible cuando el jugador deja un movimiento
+int plugin_event_fd(const PluginPlayer* plugin);
+
+// Saca el movimiento del buzón: la dirección, PLUGIN_NO_MOVE o PLUGIN_DONE
+int plugin_take_move(PluginPlayer* plugin);
+
+// Espera a que termine el hilo (el máster ya marcó is_finished y publicó) y descarga la biblioteca
+void plugin_join(PluginPlayer* plugin);
+
+// Máster: toma el estado para escribir. Los hilos de los plugins leen con un rwlock del proceso,
+// que es mucho más barato que el lightswitch de semáforos compartidos.
+void plugin_state_lock();
+void plugin_state_unlock();
+
+#endif // PLUGIN_H
@@ -0,0 +1,21 @@
+// plugin_god.c
+// Estrategia god del player (regiones libres, ver region.c) como plugin del máster:
+//   ./master -p plugin_god.so plugin_god.so
+#include "player_plugin.h"
+#include "region.h"
+
+static RegionEvaluator regions[MAX_PLAYERS]; // uno por jugador, cada uno se usa desde su hilo
+
+bool plugin_init(int width, int height, int id) {
+    return region_init(&regions[id], width, height);
+}
+
+void plugin_fini(int id) {
+    region_free(&regions[id]);
+}
+
+int choose_move(const GameState* state, int id) {
+    const Player* me = &state->players[id];
+    unsigned char dir = region_best_move(&regions[id], state->board, me->x, me->y);
+    return dir == 255 ? -1 : dir;
+}
@@ -0,0 +1,169 @@
+// record.c
+#define _POSIX_C_SOURCE 200112L // clock_gettime, ftruncate
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "record.h"
+
+#define RECORD_CHUNK 65536 // registros del primer mapeo; después se duplica
+
+static uint64_t now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static size_t file_size(size_t records) {
+    return sizeof(RecordHeader) + records * sizeof(MoveRecord);
+}
+
+// Tamaño del encabezado de la versión 1, que terminaba en los nombres
+#define RECORD_V1_HEADER_SIZE offsetof(RecordHeader, flags)
+
+static MoveRecord* writer_moves(RecordWriter* writer) {
+    return (MoveRecord*)(writer->header + 1);
+}
+
+// Agranda el archivo y lo vuelve a mapear con lugar para `capacity` registros
+static bool map_capacity(RecordWriter* writer, size_t capacity) {
+    if (ftruncate(writer->fd, file_size(capacity)) == -1) {
+        perror("ftruncate record");
+        return false;
+    }
+    if (writer->header != NULL) {
+        munmap(writer->header, file_size(writer->capacity));
+    }
+    writer->header = mmap(NULL, file_size(capacity), PROT_READ | PROT_WRITE, MAP_SHARED, writer->fd, 0);
+    if (writer->header == MAP_FAILED) {
+        perror("mmap record");
+        writer->header = NULL;
+        return false;
+    }
+    writer->capacity = capacity;
+    return true;
+}
+
+bool record_create(RecordWriter* writer, const char* path, unsigned int seed, unsigned short width, unsigned short height,
+                   unsigned int player_count, const Player players[], uint32_t flags) {
+    memset(writer, 0, sizeof(RecordWriter));
+    writer->fd = open(path, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (writer->fd == -1) {
+        perror("open record");
+        return false;
+    }
+    if (!map_capacity(writer, RECORD_CHUNK)) {
+        close(writer->fd);
+        return false;
+    }
+
+    RecordHeader* header = writer->header;
+    header->magic = RECORD_MAGIC;
+    header->version = RECORD_VERSION;
+    header->header_size = sizeof(RecordHeader);
+    header->seed = seed;
+    header->width = width;
+    header->height = height;
+    header->player_count = player_count;
+    header->record_count = 0;
+    header->flags = flags;
+    for (unsigned int i = 0; i < player_count && i < MAX_PLAYERS; i++) {
+        memcpy(header->names[i], players[i].name, MAX_NAME);
+    }
+    writer->start_ns = now_ns();
+    return true;
+}
+
+void record_move(RecordWriter* writer, int player, unsigned char dir, bool valid) {
+    if (writer->header == NULL) return; // falló un mapeo anterior, la grabación quedó cortada
+
+    size_t count = writer->header->record_count;
+    if (count == writer->capacity && !map_capacity(writer, writer->capacity * 2)) {
+        return;
+    }
+
+    MoveRecord* record = &writer_moves(writer)[count];
+    uint64_t t_us = (now_ns() - writer->start_ns) / 1000;
+    record->t_us = t_us < RECORD_T_US_MAX ? (uint32_t)t_us : RECORD_T_US_MAX;
+    record->player = player;
+    record->dir = dir;
+    record->flags = valid ? RECORD_VALID : 0;
+    record->reserved = 0;
+    writer->header->record_count = count + 1;
+}
+
+void record_close(RecordWriter* writer) {
+    if (writer->header != NULL) {
+        size_t count = writer->header->record_count;
+        munmap(writer->header, file_size(writer->capacity));
+        writer->header = NULL;
+        if (ftruncate(writer->fd, file_size(count)) == -1) {
+            perror("ftruncate record");
+        }
+    }
+    if (writer->fd != -1) {
+        close(writer->fd);
+        writer->fd = -1;
+    }
+}
+
+bool record_open(RecordReader* reader, const char* path) {
+    memset(reader, 0, sizeof(RecordReader));
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        perror("open record");
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == -1) {
+        perror("fstat record");
+        close(fd);
+        return false;
+    }
+    if ((size_t)info.st_size < RECORD_V1_HEADER_SIZE) {
+        fprintf(stderr, "%s no es una grabación (muy corto)\n", path);
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror("mmap record");
+        return false;
+    }
+    reader->header = data;
+    reader->size = info.st_size;
+
+    // Los campos de la versión 1 están en el mismo lugar; solo le falta flags
+    const RecordHeader* header = reader->header;
+    bool current = header->version == RECORD_VERSION && header->header_size == sizeof(RecordHeader);
+    bool v1 = header->version == 1 && header->header_size == RECORD_V1_HEADER_SIZE;
+    if (header->magic != RECORD_MAGIC || (!current && !v1)) {
+        fprintf(stderr, "%s no es una grabación de esta versión\n", path);
+        record_release(reader);
+        return false;
+    }
+    if (header->player_count == 0 || header->player_count > MAX_PLAYERS ||
+        header->width == 0 || header->height == 0 || header->width > BOARD_MAX || header->height > BOARD_MAX ||
+        header->header_size + header->record_count * sizeof(MoveRecord) > reader->size) {
+        fprintf(stderr, "%s tiene un encabezado inválido\n", path);
+        record_release(reader);
+        return false;
+    }
+    reader->flags = current ? header->flags : 0;
+    reader->moves = (const MoveRecord*)((const char*)header + header->header_size);
+    return true;
+}
+
+void record_release(RecordReader* reader) {
+    if (reader->header != NULL) {
+        munmap((void*)reader->header, reader->size);
+    }
+    reader->header = NULL;
+    reader->moves = NULL;
+}
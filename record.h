@@ -0,0 +1,71 @@
+// record.h
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game_state.h"
+
+// Grabación de una partida (--record): un encabezado con lo necesario para rearmar el tablero
+// (semilla, dimensiones, jugadores) y después un registro de 8 bytes por movimiento procesado.
+// El archivo se escribe a través de un mmap que crece de a bloques, así grabar un movimiento no
+// hace ninguna syscall. Si el máster muere, record_count sigue diciendo cuántos registros valen.
+#define RECORD_MAGIC 0x52315054 // "TP1R"
+#define RECORD_VERSION 2 // la 1 no tenía flags (se sigue pudiendo leer, como BOARD_RAND)
+
+#define RECORD_VALID 0x1 // el movimiento fue válido
+
+#define RECORD_T_US_MAX UINT32_MAX // MoveRecord.t_us saturado
+
+#define RECORD_BOARD_COUNTER 0x1 // RecordHeader.flags: tablero generado con BOARD_COUNTER (--rng counter)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;  // sizeof(RecordHeader), los registros empiezan ahí
+    uint32_t seed;
+    uint16_t width;
+    uint16_t height;
+    uint32_t player_count;
+    uint32_t record_count; // registros escritos, se actualiza después de cada uno
+    char names[MAX_PLAYERS][MAX_NAME];
+    uint32_t flags;        // RECORD_BOARD_COUNTER
+} RecordHeader;
+
+typedef struct {
+    uint32_t t_us;  // microsegundos desde el comienzo de la grabación (reloj monotónico); a partir de
+                    // RECORD_T_US_MAX (unos 71 minutos) queda fijo en ese valor en lugar de dar la vuelta
+    uint8_t player;
+    uint8_t dir;
+    uint8_t flags;  // RECORD_VALID
+    uint8_t reserved;
+} MoveRecord;
+
+typedef struct {
+    int fd;
+    RecordHeader* header; // comienzo del mapeo
+    size_t capacity;      // registros que entran en el mapeo actual
+    uint64_t start_ns;
+} RecordWriter;
+
+// Crea el archivo y escribe el encabezado. Devuelve false (y avisa por stderr) si no se pudo.
+bool record_create(RecordWriter* writer, const char* path, unsigned int seed, unsigned short width, unsigned short height,
+                   unsigned int player_count, const Player players[], uint32_t flags);
+void record_move(RecordWriter* writer, int player, unsigned char dir, bool valid);
+// Recorta el archivo a lo escrito y lo cierra
+void record_close(RecordWriter* writer);
+
+typedef struct {
+    const RecordHeader* header;
+    const MoveRecord* moves; // header->record_count registros
+    size_t size;
+    uint32_t flags;          // header->flags, o 0 en una grabación de la versión 1
+} RecordReader;
+
+// Mapea una grabación para leerla. Devuelve false (y avisa por stderr) si no es válida.
+bool record_open(RecordReader* reader, const char* path);
+void record_release(RecordReader* reader);
+
+#endif // RECORD_H
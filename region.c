@@ -0,0 +1,123 @@
+// region.c
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "region.h"
+#include "game_rules.h"
+
+#define REGION_BITS 3 // hay a lo sumo 8 regiones por turno, una por vecino
+#define EPOCH_MAX (UINT_MAX >> REGION_BITS)
+
+// Orden en el que se evalúan los vecinos. Es el mismo que recorría la versión con un BFS
+// por dirección, así los empates se siguen resolviendo igual.
+static const unsigned char eval_order[DIRECTIONS] = { 2, 5, 0, 3, 6, 1, 4, 7 };
+
+bool region_init(RegionEvaluator* regions, int width, int height) {
+    regions->width = width;
+    regions->height = height;
+    regions->epoch = 0;
+    regions->mark = calloc(padded_cell_count(width, height), sizeof(unsigned int));
+    regions->queue = malloc(sizeof(int) * width * height);
+    bool board_ok = padded_init(&regions->board, width, height);
+    return regions->mark != NULL && regions->queue != NULL && board_ok;
+}
+
+void region_free(RegionEvaluator* regions) {
+    free(regions->mark);
+    free(regions->queue);
+    padded_free(&regions->board);
+    regions->mark = NULL;
+    regions->queue = NULL;
+}
+
+// Etiqueta con `label` la región libre que contiene a la celda `start` y devuelve la suma de sus
+// recompensas. El borde del tablero vale 0, así que cada vecino es una lectura sin chequeos.
+// Con `stride` constante (las versiones de abajo) los desplazamientos quedan fijos en el código.
+static inline __attribute__((always_inline)) int flood_region_stride(RegionEvaluator* regions, const cell_t* cells,
+                                                                     int start, int label, int stride) {
+    const int offsets[DIRECTIONS] = PADDED_OFFSETS(stride);
+    unsigned int* mark = regions->mark;
+    int* queue = regions->queue;
+    unsigned int epoch = regions->epoch;
+
+    int front = 0, rear = 0;
+    int sum = 0;
+    unsigned int label_mark = epoch << REGION_BITS | label;
+
+    mark[start] = label_mark;
+    queue[rear++] = start;
+
+    while (front < rear) {
+        int index = queue[front++];
+        sum += cells[index];
+
+        for (int i = 0; i < DIRECTIONS; i++) {
+            int next = index + offsets[i];
+            if (cells[next] <= 0) continue;
+            if (mark[next] >> REGION_BITS == epoch) continue;
+
+            mark[next] = label_mark;
+            queue[rear++] = next;
+        }
+    }
+
+    return sum;
+}
+
+// Versiones para los anchos más usados
+#define FLOOD_REGION_FOR_WIDTH(w)                                                                  \
+    static int flood_region_##w(RegionEvaluator* regions, const cell_t* cells, int start, int label) { \
+        return flood_region_stride(regions, cells, start, label, (w) + 2);                          \
+    }
+
+FLOOD_REGION_FOR_WIDTH(10)
+FLOOD_REGION_FOR_WIDTH(20)
+FLOOD_REGION_FOR_WIDTH(100)
+
+static int flood_region(RegionEvaluator* regions, const PaddedBoard* board, int start, int label) {
+    switch (board->width) {
+        case 10: return flood_region_10(regions, board->cells, start, label);
+        case 20: return flood_region_20(regions, board->cells, start, label);
+        case 100: return flood_region_100(regions, board->cells, start, label);
+        default: return flood_region_stride(regions, board->cells, start, label, board->stride);
+    }
+}
+
+unsigned char region_best_move_padded(RegionEvaluator* regions, const PaddedBoard* board, int x, int y) {
+    int best_score = INT_MIN;
+    unsigned char best_dir = 255;
+
+    int region_score[DIRECTIONS];
+    int count = 0;
+
+    if (++regions->epoch > EPOCH_MAX) {
+        // Dio la vuelta el contador: hay que olvidar las marcas viejas
+        memset(regions->mark, 0, sizeof(unsigned int) * padded_cell_count(regions->width, regions->height));
+        regions->epoch = 1;
+    }
+
+    int here = padded_index(board, x, y);
+    for (int i = 0; i < DIRECTIONS; i++) {
+        unsigned char dir = eval_order[i];
+        int index = here + board->offsets[dir];
+        if (board->cells[index] <= 0) continue;
+
+        if (regions->mark[index] >> REGION_BITS != regions->epoch) {
+            region_score[count] = flood_region(regions, board, index, count);
+            count++;
+        }
+        int score = region_score[regions->mark[index] & ((1 << REGION_BITS) - 1)];
+
+        if (score > best_score) {
+            best_score = score;
+            best_dir = dir;
+        }
+    }
+    return best_dir;
+}
+
+unsigned char region_best_move(RegionEvaluator* regions, const cell_t* board, int x, int y) {
+    padded_load(&regions->board, board);
+    return region_best_move_padded(regions, &regions->board, x, y);
+}
@@ -0,0 +1,37 @@
+// region.h
+#ifndef REGION_H
+#define REGION_H
+
+#include <stdbool.h>
+
+#include "game_state.h"
+#include "padded_board.h"
+
+// Evaluador de regiones: en lugar de hacer un BFS completo desde cada uno de los 8 vecinos,
+// se etiquetan una sola vez por turno las regiones libres (8-conexas) que tocan a algún vecino.
+// Cada celda guarda (época << 3 | región): las marcadas con la época actual ya tienen región,
+// así no hace falta limpiar nada entre turnos. Una sola palabra por celda para que entren tableros grandes.
+// Cada evaluador es independiente, así que se puede usar uno por hilo.
+// Todo se recorre sobre el tablero con borde (padded_board.h): el flood fill no chequea límites, y para
+// los anchos más comunes (10, 20 y 100) hay versiones con los desplazamientos fijos.
+typedef struct {
+    int width;
+    int height;
+    unsigned int* mark; // época y región de cada celda, con los índices del tablero con borde
+    int* queue;         // cola del flood fill, width*height índices
+    unsigned int epoch;
+    PaddedBoard board;  // copia con borde para region_best_move
+} RegionEvaluator;
+
+bool region_init(RegionEvaluator* regions, int width, int height);
+void region_free(RegionEvaluator* regions);
+
+// Cada dirección vale la suma de la región libre a la que lleva; vecinos en la misma región
+// comparten el flood fill. Devuelve la mejor dirección desde (x, y), o 255 si no hay ninguna libre.
+// Copia el tablero a la copia con borde del evaluador y llama a region_best_move_padded.
+unsigned char region_best_move(RegionEvaluator* regions, const cell_t* board, int x, int y);
+
+// Lo mismo sobre un tablero con borde que ya mantiene el que llama (por ejemplo al día con la bitácora)
+unsigned char region_best_move_padded(RegionEvaluator* regions, const PaddedBoard* board, int x, int y);
+
+#endif // REGION_H
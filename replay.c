@@ -0,0 +1,303 @@
+// replay.c
+#define _XOPEN_SOURCE 500 // usleep, ftruncate, fchmod
+#include <fcntl.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "game_state.h"
+#include "game_ext.h"
+#include "game_rules.h"
+#include "record.h"
+
+#define EVERY_DEFAULT 1000 // movimientos entre copias del estado
+#define DELAY_DEFAULT 200
+
+/*
+Reproduce una partida grabada con el máster (--record), aplicando los movimientos con las mismas
+reglas que el máster (game_rules.c).
+
+replay file [--at N] [--every K] [-v view] [-d delay]
+
+[--at N]: Posición a mostrar: el estado después de los primeros N movimientos. Default: el final.
+[--every K]: Cada cuántos movimientos se guarda una copia del estado. Para llegar a cualquier posición
+    se restaura la copia anterior y se aplican menos de K movimientos, sin importar cuán lejos esté.
+    Default: 1000.
+[-v view]: Muestra la partida con la vista del TP, desde la posición --at hasta el final.
+[-d delay]: milisegundos entre movimientos con la vista. Default: 200
+*/
+
+char* record_file = NULL;
+long at = -1;
+unsigned int every = EVERY_DEFAULT;
+char* view = NULL;
+int delay = DELAY_DEFAULT;
+
+RecordReader reader;
+size_t state_size = 0;
+RulesGame rules;
+GameState** checkpoints = NULL; // checkpoints[i]: el estado después de i * every movimientos
+size_t checkpoint_count = 0;
+unsigned long mismatches = 0;   // movimientos cuya validez no coincide con la grabada
+
+void validate_args(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s file [--at N] [--every K] [-v view] [-d delay]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--at") == 0 && i + 1 < argc) {
+            at = atol(argv[++i]);
+            if (at < 0) {
+                fprintf(stderr, "La posición debe ser positiva\n");
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "--every") == 0 && i + 1 < argc) {
+            int value = atoi(argv[++i]);
+            if (value <= 0) {
+                fprintf(stderr, "La distancia entre copias debe ser positiva\n");
+                exit(EXIT_FAILURE);
+            }
+            every = value;
+        } else if (strcmp(argv[i], "-v") == 0 && i + 1 < argc) {
+            view = argv[++i];
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            delay = atoi(argv[++i]);
+        } else if (record_file == NULL && argv[i][0] != '-') {
+            record_file = argv[i];
+        } else {
+            fprintf(stderr, "Parámetro desconocido: %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (record_file == NULL) {
+        fprintf(stderr, "Falta el archivo de la grabación\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Estado inicial, el mismo que armó el máster: los nombres grabados hacen de rutas de los jugadores
+void init_from_header(GameState* state) {
+    const RecordHeader* header = reader.header;
+    char* names[MAX_PLAYERS];
+    for (unsigned int i = 0; i < header->player_count; i++) {
+        names[i] = (char*)header->names[i];
+    }
+    BoardGenerator generator = reader.flags & RECORD_BOARD_COUNTER ? BOARD_COUNTER : BOARD_RAND;
+    init_game_state(state, header->width, header->height, header->seed, generator, header->player_count, names);
+    if (!rules_attach(&rules, state)) {
+        perror("malloc free_neighbours");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Aplica el movimiento número index como lo hizo el máster. Devuelve false si la validez no coincide
+// con la grabada (la grabación no es de esta versión de las reglas o está dañada).
+bool apply_move(size_t index) {
+    const MoveRecord* move = &reader.moves[index];
+    if (move->player >= rules.state->player_count) {
+        return false;
+    }
+
+    bool moved = play_move(&rules, move->player, move->dir);
+    return moved == ((move->flags & RECORD_VALID) != 0);
+}
+
+GameState* copy_state(const GameState* state) {
+    GameState* copy = malloc(state_size);
+    if (copy == NULL) {
+        perror("malloc checkpoint");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(copy, state, state_size);
+    return copy;
+}
+
+// Recorre la grabación entera una vez guardando una copia cada `every` movimientos.
+// Deja en state el estado final.
+void build_checkpoints(GameState* state) {
+    size_t count = reader.header->record_count;
+    checkpoint_count = count / every + 1;
+    checkpoints = malloc(sizeof(GameState*) * checkpoint_count);
+    if (checkpoints == NULL) {
+        perror("malloc checkpoints");
+        exit(EXIT_FAILURE);
+    }
+
+    init_from_header(state);
+    checkpoints[0] = copy_state(state);
+    for (size_t i = 0; i < count; i++) {
+        if (!apply_move(i)) {
+            mismatches++;
+        }
+        if ((i + 1) % every == 0) {
+            checkpoints[(i + 1) / every] = copy_state(state);
+        }
+    }
+}
+
+// Deja en state la posición después de `position` movimientos: copia la anterior más cercana y aplica
+// lo que falta (menos de `every` movimientos)
+void seek(GameState* state, size_t position) {
+    size_t base = position / every;
+    memcpy(state, checkpoints[base], state_size);
+
+    // Los contadores de vecinos libres no son parte del estado, se recalculan desde la copia
+    rules_recount(&rules);
+    for (size_t i = base * every; i < position; i++) {
+        apply_move(i);
+    }
+}
+
+void print_scores(const GameState* state, size_t position) {
+    size_t count = reader.header->record_count;
+    uint32_t t_us = position > 0 ? reader.moves[position - 1].t_us : 0;
+    printf("Posición %zu / %zu (%s%u.%03u s)\n", position, count, t_us == RECORD_T_US_MAX ? "más de " : "",
+           t_us / 1000000, (t_us / 1000) % 1000);
+    for (unsigned int i = 0; i < state->player_count; i++) {
+        const Player* player = &state->players[i];
+        printf("Player %s (%u) at (%hu, %hu)%s with a score of %u / %u / %u\n",
+               player->name, i, player->x, player->y, player->is_blocked ? " blocked" : "",
+               player->score, player->valid_moves, player->invalid_moves);
+    }
+}
+
+// Muestra la partida con la vista desde `position`, con el mismo protocolo que el máster
+// (changes_available / print_done). La vista no distingue una partida grabada de una en vivo.
+void play_with_view(const GameState* start, size_t position) {
+    char state_name[NS_NAME_MAX], sync_name[NS_NAME_MAX];
+    ns_name(state_name, sizeof(state_name), SHM_STATE);
+    ns_name(sync_name, sizeof(sync_name), SHM_SYNC);
+
+    int shm_fd = shm_open(state_name, O_CREAT | O_RDWR, 0644);
+    if (shm_fd < 0 || ftruncate(shm_fd, state_size) == -1) {
+        perror("shm state");
+        exit(EXIT_FAILURE);
+    }
+    GameState* state = mmap(NULL, state_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if (state == MAP_FAILED) {
+        perror("mmap state");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(state, start, state_size);
+    state->is_finished = false;
+
+    int sync_fd = shm_open(sync_name, O_CREAT | O_RDWR, 0666);
+    if (sync_fd < 0 || ftruncate(sync_fd, sizeof(SyncState)) == -1) {
+        perror("shm sync");
+        exit(EXIT_FAILURE);
+    }
+    fchmod(sync_fd, 0666);
+    SyncState* sync = mmap(NULL, sizeof(SyncState), PROT_READ | PROT_WRITE, MAP_SHARED, sync_fd, 0);
+    if (sync == MAP_FAILED) {
+        perror("mmap sync");
+        exit(EXIT_FAILURE);
+    }
+    sem_init(&sync->changes_available, 1, 0);
+    sem_init(&sync->print_done, 1, 0);
+
+    // Solo para que la vista compruebe el tamaño de las celdas
+    GameExt* ext = ext_create(SYNC_LIGHTSWITCH, sizeof(cell_t), 0);
+    if (ext == NULL) {
+        exit(EXIT_FAILURE);
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork vista");
+        exit(EXIT_FAILURE);
+    }
+    if (pid == 0) {
+        char width_str[8], height_str[8];
+        snprintf(width_str, sizeof(width_str), "%hu", state->width);
+        snprintf(height_str, sizeof(height_str), "%hu", state->height);
+        execl(view, view, width_str, height_str, NULL);
+        perror("execl vista");
+        exit(EXIT_FAILURE);
+    }
+
+    // Desde acá se juega sobre el estado compartido. Los contadores de vecinos libres siguen valiendo:
+    // se calcularon sobre la copia, que es igual byte a byte
+    rules.state = state;
+    size_t count = reader.header->record_count;
+    sem_post(&sync->changes_available);
+    sem_wait(&sync->print_done);
+    for (size_t i = position; i < count && !state->is_finished; i++) {
+        usleep(delay * 1000);
+        apply_move(i);
+        state->is_finished = state->is_finished || i + 1 == count;  // el máster cortó por timeout
+        sem_post(&sync->changes_available);
+        sem_wait(&sync->print_done);
+    }
+    if (!state->is_finished) {
+        // Grabación sin movimientos después de la posición: igual hay que dejar terminar a la vista
+        state->is_finished = true;
+        sem_post(&sync->changes_available);
+        sem_wait(&sync->print_done);
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) != -1 && WIFEXITED(status)) {
+        printf("View exited (%d)\n", WEXITSTATUS(status));
+    }
+    print_scores(state, count);
+
+    munmap(state, state_size);
+    munmap(sync, sizeof(SyncState));
+    close(shm_fd);
+    close(sync_fd);
+    shm_unlink(state_name);
+    shm_unlink(sync_name);
+    ext_destroy(ext);
+}
+
+int main(int argc, char* argv[]) {
+    validate_args(argc, argv);
+    if (!record_open(&reader, record_file)) {
+        exit(EXIT_FAILURE);
+    }
+
+    const RecordHeader* header = reader.header;
+    size_t count = header->record_count;
+    printf("Grabación %s: %hux%hu, semilla %u, %u jugadores, %zu movimientos\n",
+           record_file, header->width, header->height, header->seed, header->player_count, count);
+
+    state_size = sizeof(GameState) + sizeof(cell_t) * header->width * header->height;
+    GameState* state = malloc(state_size);
+    if (state == NULL) {
+        perror("malloc state");
+        exit(EXIT_FAILURE);
+    }
+
+    build_checkpoints(state);
+    if (mismatches > 0) {
+        fprintf(stderr, "Atención: %lu movimientos no dan la misma validez que en la partida grabada\n", mismatches);
+    }
+
+    size_t position = at < 0 || (size_t)at > count ? count : (size_t)at;
+    if (position != count) {
+        seek(state, position);
+    }
+
+    if (view != NULL) {
+        play_with_view(state, position);
+    } else {
+        print_scores(state, position);
+    }
+
+    rules_detach(&rules);
+    for (size_t i = 0; i < checkpoint_count; i++) {
+        free(checkpoints[i]);
+    }
+    free(checkpoints);
+    free(state);
+    record_release(&reader);
+    return mismatches > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,15 @@
+// search.h
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdbool.h>
+
+// Lo que las estrategias que simulan la partida (mcts, alphabeta) necesitan saber de cada jugador,
+// además del tablero
+typedef struct {
+    int x;
+    int y;
+    bool blocked;
+} SearchPlayer;
+
+#endif // SEARCH_H
@@ -0,0 +1,204 @@
+// simulate.c
+#define _POSIX_C_SOURCE 199309L // clock_gettime
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "game_state.h"
+#include "game_rules.h"
+#include "region.h"
+
+#define GAMES_DEFAULT 10000
+#define BATCH 1024 // resultados por llamada a simulate_games
+
+/*
+Juega muchas partidas sin máster, sin procesos ni memoria compartida, con las mismas reglas que el
+máster (game_rules.c), y muestra cuántas gana cada política y el puntaje promedio.
+
+simulate [-w width] [-h height] [-n games] [-s seed] [-m max_moves] [-r rand|counter] -p policy1 policy2 ...
+
+[-w width] [-h height]: Dimensiones del tablero. Default: 10
+[-n games]: Cantidad de partidas, con semillas seed, seed + 1, ... Default: 10000
+[-s seed]: Semilla de la primera partida. Default: time(NULL)
+[-m max_moves]: Movimientos máximos por partida. Default: 8 por celda
+[-r rand|counter]: Generador del tablero, como --rng en el máster. Default: rand
+-p policy: Una por jugador: first, random, greedy (la celda vecina de más valor) o god (la región
+    libre de más valor, la estrategia default del player).
+*/
+
+typedef enum {
+    POLICY_FIRST,
+    POLICY_RANDOM,
+    POLICY_GREEDY,
+    POLICY_GOD,
+} PolicyKind;
+
+const char* policy_names[] = { "first", "random", "greedy", "god" };
+
+unsigned short width = 10;
+unsigned short height = 10;
+unsigned long game_count = GAMES_DEFAULT;
+unsigned int seed;
+unsigned int max_moves = 0;
+BoardGenerator generator = BOARD_RAND;
+unsigned int player_count = 0;
+PolicyKind policies[MAX_PLAYERS];
+
+RegionEvaluator regions;
+uint64_t random_state = 0;
+
+void validate_args(int argc, char* argv[]) {
+    seed = time(NULL);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-h") == 0 && i + 1 < argc) {
+            height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            game_count = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            max_moves = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "rand") == 0) {
+                generator = BOARD_RAND;
+            } else if (strcmp(argv[i], "counter") == 0) {
+                generator = BOARD_COUNTER;
+            } else {
+                fprintf(stderr, "Generador desconocido: %s\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        } else if (strcmp(argv[i], "-p") == 0) {
+            while (i + 1 < argc && argv[i + 1][0] != '-' && player_count < MAX_PLAYERS) {
+                i++;
+                int kind = -1;
+                for (int k = 0; k < (int)(sizeof(policy_names) / sizeof(policy_names[0])); k++) {
+                    if (strcmp(argv[i], policy_names[k]) == 0) kind = k;
+                }
+                if (kind < 0) {
+                    fprintf(stderr, "Política desconocida: %s\n", argv[i]);
+                    exit(EXIT_FAILURE);
+                }
+                policies[player_count++] = kind;
+            }
+        } else {
+            fprintf(stderr, "Uso: %s [-w width] [-h height] [-n games] [-s seed] [-m max_moves] [-r rand|counter] -p policy1 policy2 ...\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if (width < 1 || width > BOARD_MAX || height < 1 || height > BOARD_MAX) {
+        fprintf(stderr, "Las dimensiones del tablero deben estar entre 1 y %d\n", BOARD_MAX);
+        exit(EXIT_FAILURE);
+    }
+    if (player_count == 0) {
+        fprintf(stderr, "Debe haber al menos una política especificada con -p\n");
+        exit(EXIT_FAILURE);
+    }
+    if (max_moves == 0) {
+        max_moves = 8u * width * height;
+    }
+}
+
+static uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+unsigned char choose_move(const GameState* state, int player_id, void* arg) {
+    (void)arg; // la política de cada jugador está en `policies`
+    const Player* me = &state->players[player_id];
+    switch (policies[player_id]) {
+        case POLICY_FIRST:
+            for (unsigned char dir = 0; dir < DIRECTIONS; dir++) {
+                if (can_move_to(state->board, width, height, me->x, me->y, dir)) return dir;
+            }
+            return 0;
+        case POLICY_RANDOM: {
+            unsigned char free_dirs[DIRECTIONS];
+            int count = 0;
+            for (unsigned char dir = 0; dir < DIRECTIONS; dir++) {
+                if (can_move_to(state->board, width, height, me->x, me->y, dir)) free_dirs[count++] = dir;
+            }
+            return count ? free_dirs[splitmix64(&random_state) % count] : 0;
+        }
+        case POLICY_GREEDY: {
+            unsigned char best = 0;
+            int best_value = 0;
+            for (unsigned char dir = 0; dir < DIRECTIONS; dir++) {
+                if (!can_move_to(state->board, width, height, me->x, me->y, dir)) continue;
+                int value = state->board[(me->y + dy[dir]) * width + me->x + dx[dir]];
+                if (value > best_value) {
+                    best_value = value;
+                    best = dir;
+                }
+            }
+            return best;
+        }
+        case POLICY_GOD:
+            return region_best_move(&regions, state->board, me->x, me->y);
+    }
+    return 0;
+}
+
+static double elapsed_seconds(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    validate_args(argc, argv);
+
+    // Toda la memoria se pide una vez: las partidas se juegan una atrás de otra sobre el mismo bloque
+    void* memory = malloc(rules_game_size(width, height));
+    SimResult* results = malloc(sizeof(SimResult) * BATCH);
+    if (memory == NULL || results == NULL || !region_init(&regions, width, height)) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    random_state = seed;
+
+    unsigned long wins[MAX_PLAYERS] = { 0 };
+    unsigned long long scores[MAX_PLAYERS] = { 0 };
+    unsigned long long total_moves = 0;
+    unsigned long unfinished = 0;
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long done = 0; done < game_count; done += BATCH) {
+        size_t batch = game_count - done < BATCH ? game_count - done : BATCH;
+        simulate_games(memory, width, height, player_count, seed + done, generator, batch, max_moves, choose_move, NULL, results);
+        for (size_t g = 0; g < batch; g++) {
+            total_moves += results[g].moves;
+            if (!results[g].finished) unfinished++;
+            for (unsigned int i = 0; i < player_count; i++) {
+                scores[i] += results[g].scores[i];
+                if (results[g].winners[i]) wins[i]++;
+            }
+        }
+    }
+    double seconds = elapsed_seconds(&start);
+
+    printf("%lu partidas de %hux%hu en %.3f s: %.0f partidas/s, %.0f movimientos/s", game_count, width, height,
+           seconds, game_count / seconds, total_moves / seconds);
+    if (unfinished > 0) {
+        printf(" (%lu cortadas a los %u movimientos)", unfinished, max_moves);
+    }
+    printf("\n");
+    for (unsigned int i = 0; i < player_count; i++) {
+        printf("Player %u (%s): %lu victorias (%.1f%%), puntaje promedio %.1f\n", i, policy_names[policies[i]],
+               wins[i], 100.0 * wins[i] / game_count, (double)scores[i] / game_count);
+    }
+
+    region_free(&regions);
+    free(results);
+    free(memory);
+    return 0;
+}
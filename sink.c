@@ -0,0 +1,378 @@
+// sink.c
+#define _GNU_SOURCE // posix_fallocate, MAP_POPULATE
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <semaphore.h>
+
+#include <time.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "game_state.h"
+#include "game_ext.h"
+#include "sink.h"
+#include "telemetry.h"
+
+/*
+Vista sin pantalla: se lanza como cualquier vista (./master -v sink ...) y en lugar de dibujar escribe
+cada cambio de estado como un cuadro binario (formato en sink.h) en un archivo mapeado y reservado de
+antemano. Por cuadro solo se copian los jugadores y las celdas nuevas (de la bitácora de /game_ext, o
+comparando con el cuadro anterior si no está o se atrasó), y cada tanto el tablero entero. No hay
+ningún printf ni syscall por cuadro salvo cuando el archivo se llena y hay que agrandarlo.
+Si el archivo no se puede crear o agrandar, avisa una vez y sigue atendiendo el handshake sin escribir
+cuadros, así el máster no se queda esperando print_done.
+
+Se configura con variables de entorno, que hereda del máster:
+SINK_FILE: Archivo de salida. Default: /tmp/game.sink. Como la vista corre con el uid 1000 (el máster
+    le baja los permisos), el directorio tiene que ser escribible por ese usuario.
+SINK_EVERY: Escribe un cuadro cada n cambios de estado (con el handshake de la vista). Default: 1
+SINK_KEYFRAME: Cuadros entre dos keyframes. Default: 256
+SINK_MB: Megabytes que se reservan al empezar; si no alcanzan el archivo se duplica. Default: 64
+
+Con --view-fps el máster no la espera y sink toma view_fps cuadros por segundo, copiando con el
+contador del seqlock como la vista.
+*/
+
+#define SINK_FILE_DEFAULT "/tmp/game.sink"
+#define SINK_EVERY_DEFAULT 1
+#define SINK_KEYFRAME_DEFAULT 256
+#define SINK_MB_DEFAULT 64
+#define SNAPSHOT_TRIES 16 // intentos de copia por cuadro con --view-fps antes de saltearlo
+
+int sink_fd = -1;
+SinkHeader* header = NULL; // comienzo del mapeo del archivo
+size_t capacity = 0;       // bytes mapeados
+
+unsigned int keyframe_every = SINK_KEYFRAME_DEFAULT;
+unsigned int frames_since_key = 0;
+unsigned int keyframes = 0;
+
+// Tablero del último cuadro escrito: contra esto se calculan los deltas si no alcanza la bitácora
+cell_t* last_board = NULL;
+bool last_loaded = false;
+unsigned int last_head = 0; // movimientos de la bitácora incluidos en el último cuadro
+bool last_finished = false;
+
+uint64_t start_ns = 0;
+
+int env_int(const char* name, int default_value) {
+    const char* value = getenv(name);
+    if (value == NULL) return default_value;
+    int parsed = atoi(value);
+    return parsed > 0 ? parsed : default_value;
+}
+
+static uint64_t now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+// Agranda el archivo (reservando los bloques) y lo vuelve a mapear con `size` bytes
+static bool map_capacity(size_t size) {
+    int error = posix_fallocate(sink_fd, 0, size);
+    if (error != 0 && ftruncate(sink_fd, size) == -1) {
+        perror("[sink] ftruncate");
+        return false;
+    }
+    if (header != NULL) {
+        munmap(header, capacity);
+    }
+    // MAP_POPULATE: las páginas ya están en memoria, los cuadros no pagan fallos de página
+    header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, sink_fd, 0);
+    if (header == MAP_FAILED) {
+        perror("[sink] mmap");
+        header = NULL;
+        return false;
+    }
+    capacity = size;
+    return true;
+}
+
+static size_t frame_max(const GameState* state);
+
+bool sink_create(const char* path, size_t size, const GameState* state) {
+    sink_fd = open(path, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (sink_fd == -1) {
+        perror("[sink] open");
+        return false;
+    }
+    // Al menos el encabezado y el primer keyframe
+    if (size < sizeof(SinkHeader) + frame_max(state)) size = sizeof(SinkHeader) + frame_max(state);
+    if (!map_capacity(size)) {
+        return false;
+    }
+
+    header->magic = SINK_MAGIC;
+    header->version = SINK_VERSION;
+    header->header_size = sizeof(SinkHeader);
+    header->width = state->width;
+    header->height = state->height;
+    header->player_count = state->player_count;
+    header->cell_size = sizeof(cell_t);
+    header->keyframe_every = keyframe_every;
+    header->frame_count = 0;
+    header->used = sizeof(SinkHeader);
+    for (unsigned int i = 0; i < state->player_count && i < MAX_PLAYERS; i++) {
+        memcpy(header->names[i], state->players[i].name, MAX_NAME);
+    }
+    return true;
+}
+
+// Recorta el archivo a lo escrito y lo cierra
+void sink_close() {
+    if (header != NULL) {
+        size_t used = header->used;
+        munmap(header, capacity);
+        header = NULL;
+        if (ftruncate(sink_fd, used) == -1) {
+            perror("[sink] ftruncate");
+        }
+    }
+    if (sink_fd != -1) {
+        close(sink_fd);
+        sink_fd = -1;
+    }
+}
+
+static size_t board_bytes(const GameState* state) {
+    return sizeof(cell_t) * state->width * state->height;
+}
+
+// Lo más grande que puede ocupar un cuadro: un delta que no entra en el tamaño del tablero se
+// escribe como keyframe
+static size_t frame_max(const GameState* state) {
+    return sizeof(SinkFrame) + sizeof(SinkPlayer) * state->player_count + board_bytes(state) + 8;
+}
+
+// Celdas que cambiaron desde el último cuadro, en cells (a lo sumo limit). Primero con la bitácora,
+// y si se atrasó más que el buffer (o no hay /game_ext) comparando con last_board. Devuelve false si
+// son más de limit.
+static bool collect_delta(const GameState* state, const GameExt* ext, unsigned int head,
+                          SinkCell* cells, uint32_t limit, uint32_t* count) {
+    *count = 0;
+    if (ext != NULL && head - last_head <= limit && head - last_head <= JOURNAL_SIZE) {
+        JournalEntry entry;
+        unsigned int seq = last_head;
+        while (seq != head && ext_journal_read(ext, seq + 1, &entry)) {
+            cells[*count].index = entry.to;
+            cells[*count].value = -entry.player_id;
+            (*count)++;
+            seq++;
+        }
+        if (seq == head) return true;
+        *count = 0;
+    }
+
+    int total = state->width * state->height;
+    for (int i = 0; i < total; i++) {
+        if (state->board[i] == last_board[i]) continue;
+        if (*count == limit) return false;
+        cells[*count].index = i;
+        cells[*count].value = state->board[i];
+        (*count)++;
+    }
+    return true;
+}
+
+// Escribe un cuadro con el estado actual al final del archivo. Con ext la copia va entre
+// ext_read_begin y ext_read_retry, así con --view-fps un cuadro que el máster pisó a la mitad no
+// se publica; devuelve false en ese caso (o si no hubo lugar).
+bool write_frame(const GameState* state, const GameExt* ext, unsigned int changes) {
+    if (header == NULL) return false; // falló un mapeo anterior, el archivo quedó cortado
+    if (header->used + frame_max(state) > capacity) {
+        size_t size = capacity;
+        while (header->used + frame_max(state) > size) size *= 2;
+        if (!map_capacity(size)) return false;
+    }
+
+    unsigned char* base = (unsigned char*)header + header->used;
+    SinkFrame* frame = (SinkFrame*)base;
+    SinkPlayer* players = (SinkPlayer*)(frame + 1);
+    void* cells = players + state->player_count;
+
+    unsigned int seq = ext != NULL ? ext_read_begin(ext) : 0;
+    unsigned int head = ext != NULL ? __atomic_load_n(&ext->journal_head, __ATOMIC_ACQUIRE) : 0;
+
+    for (int i = 0; i < state->player_count; i++) {
+        const Player* player = &state->players[i];
+        players[i] = (SinkPlayer){ player->score, player->valid_moves, player->invalid_moves,
+                                   player->x, player->y, player->is_blocked, { 0 } };
+    }
+
+    uint32_t count = 0;
+    bool key = !last_loaded || frames_since_key + 1 >= keyframe_every ||
+               !collect_delta(state, ext, head, cells, board_bytes(state) / sizeof(SinkCell), &count);
+    if (key) {
+        count = state->width * state->height;
+        memcpy(cells, state->board, board_bytes(state));
+    }
+    bool finished = state->is_finished;
+    frame->version = ext != NULL ? ext_version(ext) : changes;
+
+    if (ext != NULL && ext_read_retry(ext, seq)) {
+        return false;
+    }
+
+    size_t body = key ? board_bytes(state) : count * sizeof(SinkCell);
+    size_t size = (sizeof(SinkFrame) + sizeof(SinkPlayer) * state->player_count + body + 7) & ~(size_t)7;
+    frame->size = size;
+    frame->kind = key ? SINK_KEYFRAME : SINK_DELTA;
+    frame->flags = finished ? SINK_FINISHED : 0;
+    frame->reserved = 0;
+    frame->cells = count;
+    frame->t_ns = now_ns() - start_ns;
+
+    // El tablero del cuadro pasa a ser la base del próximo delta
+    if (key) {
+        memcpy(last_board, cells, board_bytes(state));
+        frames_since_key = 0;
+        keyframes++;
+    } else {
+        const SinkCell* delta = cells;
+        for (uint32_t i = 0; i < count; i++) {
+            last_board[delta[i].index] = delta[i].value;
+        }
+        frames_since_key++;
+    }
+    last_loaded = true;
+    last_head = head;
+    last_finished = finished;
+
+    header->frame_count++;
+    __atomic_store_n(&header->used, header->used + size, __ATOMIC_RELEASE);
+    return true;
+}
+
+// --view-fps: un cuadro cada 1/view_fps segundos hasta escribir el estado final. Sin archivo (no se
+// pudo crear o agrandar) no hay nada que hacer: el máster no espera a la vista en este modo.
+void run_async(const GameState* state, const GameExt* ext, Telemetry* telemetry) {
+    long period_ns = 1000000000L / ext->view_fps;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (!last_finished && header != NULL) {
+        uint64_t frame_ns = telemetry ? telemetry_now_ns() : 0;
+        bool written = false;
+        for (int attempt = 0; attempt < SNAPSHOT_TRIES && !written; attempt++) {
+            written = write_frame(state, ext, 0);
+        }
+        if (written && telemetry) telemetry_record(&telemetry->view_render, telemetry_now_ns() - frame_ns);
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        next.tv_nsec += period_ns;
+        next.tv_sec += next.tv_nsec / 1000000000L;
+        next.tv_nsec %= 1000000000L;
+        if (next.tv_sec < now.tv_sec || (next.tv_sec == now.tv_sec && next.tv_nsec < now.tv_nsec)) {
+            next = now;
+        }
+        if (!last_finished && header != NULL) {
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Uso: %s <ancho> <alto>\n", argv[0]);
+        return 1;
+    }
+    unsigned short width = (unsigned short)atoi(argv[1]);
+    unsigned short height = (unsigned short)atoi(argv[2]);
+    start_ns = now_ns();
+
+    char state_name[NS_NAME_MAX], sync_name[NS_NAME_MAX];
+    ns_name(state_name, sizeof(state_name), SHM_STATE);
+    ns_name(sync_name, sizeof(sync_name), SHM_SYNC);
+
+    int shm_fd = shm_open(state_name, O_RDONLY, 0);
+    if (shm_fd < 0) {
+        perror("[sink] shm_open state");
+        return 1;
+    }
+
+    GameExt* ext = ext_attach(sizeof(cell_t));
+    unsigned int map_flags = ext != NULL ? ext->map_flags : 0;
+    Telemetry* telemetry = telemetry_attach();
+
+    size_t state_size = ext_state_map_size(sizeof(GameState) + sizeof(cell_t) * width * height, map_flags);
+    GameState* state = mmap(NULL, state_size, PROT_READ, MAP_SHARED, shm_fd, 0);
+    if (state == MAP_FAILED) {
+        perror("[sink] mmap state");
+        return 1;
+    }
+    ext_prepare_mapping(state, state_size, map_flags);
+
+    int sync_fd = shm_open(sync_name, O_RDWR, 0666);
+    if (sync_fd < 0) {
+        perror("[sink] shm_open sync");
+        return 1;
+    }
+    SyncState* sync = mmap(NULL, sizeof(SyncState), PROT_READ | PROT_WRITE, MAP_SHARED, sync_fd, 0);
+    if (sync == MAP_FAILED) {
+        perror("[sink] mmap sync");
+        return 1;
+    }
+
+    const char* path = getenv("SINK_FILE") != NULL ? getenv("SINK_FILE") : SINK_FILE_DEFAULT;
+    unsigned int every = env_int("SINK_EVERY", SINK_EVERY_DEFAULT);
+    keyframe_every = env_int("SINK_KEYFRAME", SINK_KEYFRAME_DEFAULT);
+    size_t reserve = (size_t)env_int("SINK_MB", SINK_MB_DEFAULT) * 1024 * 1024;
+
+    last_board = malloc(sizeof(cell_t) * width * height);
+    if (last_board == NULL) {
+        perror("[sink] malloc");
+        return 1;
+    }
+    if (!sink_create(path, reserve, state)) {
+        fprintf(stderr, "[sink] No se puede escribir %s, la partida sigue sin grabarse\n", path);
+    }
+    if (map_flags & EXT_PREFAULT) {
+        ext_signal_ready(ext);
+    }
+
+    bool async = ext != NULL && ext->view_fps > 0;
+    if (async) {
+        run_async(state, ext, telemetry);
+    }
+
+    // Handshake de la vista: el máster espera print_done después de cada cambio, haya archivo o no
+    unsigned int changes = 0;
+    while (!async && !last_finished && !state->is_finished) {
+        sem_wait(&sync->changes_available);
+        uint64_t frame_ns = telemetry ? telemetry_now_ns() : 0;
+        changes++;
+        if (changes % every == 0 || state->is_finished) {
+            write_frame(state, ext, changes);
+            if (telemetry) telemetry_record(&telemetry->view_render, telemetry_now_ns() - frame_ns);
+        }
+        sem_post(&sync->print_done);
+    }
+    // El estado final siempre queda en el archivo, aunque no haya caído en un múltiplo de SINK_EVERY
+    if (!last_finished) {
+        write_frame(state, ext, changes);
+    }
+
+    if (header != NULL) {
+        printf("[sink] %u cuadros (%u keyframes), %zu bytes en %s\n", header->frame_count, keyframes,
+               (size_t)header->used, path);
+    }
+    sink_close();
+
+    free(last_board);
+    ext_detach(ext);
+    telemetry_detach(telemetry);
+    munmap(state, state_size);
+    munmap(sync, sizeof(SyncState));
+    close(shm_fd);
+    close(sync_fd);
+    return 0;
+}
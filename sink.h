@@ -0,0 +1,62 @@
+// sink.h
+#ifndef SINK_H
+#define SINK_H
+
+#include <stdint.h>
+
+#include "game_state.h"
+
+// Formato del archivo que escribe `sink`, la vista sin pantalla: un encabezado y después una
+// secuencia de cuadros binarios, uno por cambio de estado (o cada SINK_EVERY cambios). Un cuadro
+// completo (keyframe) trae el tablero entero; los demás (delta) traen solo las celdas que cambiaron
+// desde el cuadro anterior. Los dos traen todos los jugadores. Para rearmar cualquier cuadro alcanza
+// con el último keyframe anterior y los deltas que siguen. Los valores se copian tal como están en
+// memoria (little endian en las máquinas donde corre el juego), sin formatear nada.
+#define SINK_MAGIC 0x53315054 // "TP1S"
+#define SINK_VERSION 1
+
+#define SINK_KEYFRAME 1 // SinkFrame.kind: sigue el tablero entero (width * height celdas de cell_size bytes)
+#define SINK_DELTA 2    // SinkFrame.kind: siguen SinkFrame.cells registros SinkCell
+
+#define SINK_FINISHED 0x1 // SinkFrame.flags: el estado del cuadro es el final (is_finished)
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;     // sizeof(SinkHeader), el primer cuadro empieza ahí
+    uint16_t width;
+    uint16_t height;
+    uint16_t player_count;
+    uint16_t cell_size;       // sizeof(cell_t) del build (4, o 1 con COMPACT=1)
+    uint32_t keyframe_every;  // cuadros entre dos keyframes (puede haber alguno antes)
+    uint32_t frame_count;     // cuadros escritos
+    uint64_t used;            // bytes válidos desde el comienzo del archivo; se actualiza después de cada cuadro
+    char names[MAX_PLAYERS][MAX_NAME];
+} SinkHeader;
+
+typedef struct {
+    uint32_t size;    // bytes del cuadro contando este encabezado, múltiplo de 8
+    uint8_t kind;     // SINK_KEYFRAME o SINK_DELTA
+    uint8_t flags;    // SINK_FINISHED
+    uint16_t reserved;
+    uint32_t cells;   // celdas que siguen a los jugadores (en un keyframe, width * height)
+    uint32_t version; // versión del estado (ext_version) o, sin /game_ext, cambios vistos
+    uint64_t t_ns;    // nanosegundos desde que arrancó sink (reloj monotónico)
+} SinkFrame;          // seguido de player_count SinkPlayer y después las celdas
+
+typedef struct {
+    uint32_t score;
+    uint32_t valid_moves;
+    uint32_t invalid_moves;
+    uint16_t x;
+    uint16_t y;
+    uint8_t blocked;
+    uint8_t reserved[3];
+} SinkPlayer;
+
+typedef struct {
+    uint32_t index; // y * width + x
+    int32_t value;  // valor nuevo de la celda
+} SinkCell;
+
+#endif // SINK_H
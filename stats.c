@@ -0,0 +1,120 @@
+// stats.c
+#define _XOPEN_SOURCE 500 // usleep, kill
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "telemetry.h"
+
+#define INTERVAL_DEFAULT 1000
+
+/*
+Muestra en vivo la telemetría de una partida corrida con `master --telemetry`. Respeta GAME_NS para
+mirar una partida con namespace.
+
+stats [-i interval] [-n count]
+
+[-i interval]: milisegundos entre cada reporte. Default: 1000
+[-n count]: cantidad de reportes antes de salir. Default: hasta que termine el máster
+*/
+
+int interval = INTERVAL_DEFAULT;
+int report_count = 0;
+
+void validate_args(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            report_count = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Uso: %s [-i interval] [-n count]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (interval <= 0) {
+        fprintf(stderr, "El intervalo debe ser positivo\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static double us(uint64_t ns) {
+    return ns / 1000.0;
+}
+
+void print_histogram(const char* label, const Histogram* histogram) {
+    uint64_t count = __atomic_load_n(&histogram->count, __ATOMIC_ACQUIRE);
+    uint64_t sum = __atomic_load_n(&histogram->sum_ns, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&histogram->max_ns, __ATOMIC_RELAXED);
+    printf("  %-14s %10llu %10.1f %10.1f %10.1f %10.1f\n", label, (unsigned long long)count,
+           count ? us(sum / count) : 0.0, us(telemetry_percentile(histogram, 50)),
+           us(telemetry_percentile(histogram, 99)), us(max));
+}
+
+void print_report(const Telemetry* telemetry, uint64_t moves_per_second) {
+    uint64_t moves = __atomic_load_n(&telemetry->moves, __ATOMIC_RELAXED);
+    uint64_t invalid = __atomic_load_n(&telemetry->invalid_moves, __ATOMIC_RELAXED);
+    uint64_t discarded = __atomic_load_n(&telemetry->discarded_moves, __ATOMIC_RELAXED);
+    printf("Máster %d: %llu movimientos (%llu inválidos), %llu descartados, %llu mov/s\n", telemetry->master_pid,
+           (unsigned long long)moves, (unsigned long long)invalid, (unsigned long long)discarded,
+           (unsigned long long)moves_per_second);
+    printf("  %-14s %10s %10s %10s %10s %10s\n", "(µs)", "muestras", "promedio", "p50", "p99", "max");
+    print_histogram("lock wait", &telemetry->lock_wait);
+    print_histogram("hold", &telemetry->hold);
+    print_histogram("view wait", &telemetry->view_wait);
+    print_histogram("view render", &telemetry->view_render);
+
+    for (unsigned int i = 0; i < telemetry->player_count && i < MAX_PLAYERS; i++) {
+        const PlayerTelemetry* player = &telemetry->players[i];
+        printf("Player %s (%u): %llu enviados, %llu lecturas, %llu reintentos\n", telemetry->names[i], i,
+               (unsigned long long)__atomic_load_n(&player->moves_sent, __ATOMIC_RELAXED),
+               (unsigned long long)__atomic_load_n(&player->reads, __ATOMIC_RELAXED),
+               (unsigned long long)__atomic_load_n(&player->read_retries, __ATOMIC_RELAXED));
+        print_histogram("reaction", &player->reaction);
+        print_histogram("read wait", &player->read_wait);
+        print_histogram("read hold", &player->read_hold);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    validate_args(argc, argv);
+
+    Telemetry* telemetry = telemetry_open();
+    if (telemetry == NULL) {
+        fprintf(stderr, "No hay una partida corriendo con --telemetry\n");
+        return EXIT_FAILURE;
+    }
+
+    uint64_t last_moves = __atomic_load_n(&telemetry->moves, __ATOMIC_RELAXED);
+    uint64_t last_ns = telemetry_now_ns();
+    for (int reports = 0; report_count == 0 || reports < report_count; reports++) {
+        if (reports > 0 || report_count != 1) {
+            usleep(interval * 1000);
+        }
+
+        uint64_t moves = __atomic_load_n(&telemetry->moves, __ATOMIC_RELAXED);
+        uint64_t now_ns = telemetry_now_ns();
+        uint64_t elapsed_ns = now_ns - last_ns;
+        print_report(telemetry, elapsed_ns ? (moves - last_moves) * 1000000000ULL / elapsed_ns : 0);
+        last_ns = now_ns;
+
+        // El mapeo sigue valiendo aunque el máster borre el segmento al terminar la partida, así que se
+        // vuelve a abrir por nombre: si ya no está se terminó, y en modo benchmark puede ser el de la siguiente
+        Telemetry* current = telemetry_open();
+        if (current == NULL || (kill(current->master_pid, 0) == -1 && errno == ESRCH)) {
+            telemetry_detach(current);
+            break;
+        }
+        telemetry_detach(telemetry);
+        telemetry = current;
+        last_moves = __atomic_load_n(&telemetry->moves, __ATOMIC_RELAXED);
+    }
+
+    telemetry_detach(telemetry);
+    return EXIT_SUCCESS;
+}
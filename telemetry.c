@@ -0,0 +1,131 @@
+// telemetry.c
+#define _XOPEN_SOURCE 500 // clock_gettime, ftruncate, fchmod, fchown
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "telemetry.h"
+#include "game_ext.h"
+
+Telemetry* telemetry_create() {
+    char name[NS_NAME_MAX];
+    ns_name(name, sizeof(name), SHM_TELEMETRY);
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("shm_open telemetry");
+        return NULL;
+    }
+    // Los players y la vista corren como EXT_READER_UID y escriben sus contadores: el segmento pasa a
+    // ser de ese usuario y el resto (stats) solo puede leerlo. Sin root los hijos corren con el
+    // mismo usuario que el máster y no hace falta cambiar el dueño.
+    fchmod(fd, 0644);
+    if (fchown(fd, EXT_READER_UID, -1) == -1 && getuid() == 0) {
+        perror("fchown telemetry");
+    }
+    if (ftruncate(fd, sizeof(Telemetry)) == -1) {
+        perror("ftruncate telemetry");
+        close(fd);
+        return NULL;
+    }
+    Telemetry* telemetry = mmap(NULL, sizeof(Telemetry), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (telemetry == MAP_FAILED) {
+        perror("mmap telemetry");
+        return NULL;
+    }
+
+    // ftruncate sobre un segmento recién truncado ya deja todo en cero
+    telemetry->master_pid = getpid();
+    __atomic_store_n(&telemetry->magic, TELEMETRY_MAGIC, __ATOMIC_RELEASE);
+    return telemetry;
+}
+
+void telemetry_destroy(Telemetry* telemetry) {
+    if (telemetry == NULL) return;
+    if (munmap(telemetry, sizeof(Telemetry)) == -1) {
+        perror("munmap telemetry");
+    }
+    char name[NS_NAME_MAX];
+    ns_name(name, sizeof(name), SHM_TELEMETRY);
+    if (shm_unlink(name) == -1) {
+        perror("shm_unlink telemetry");
+    }
+}
+
+static Telemetry* map_existing(int prot) {
+    char name[NS_NAME_MAX];
+    ns_name(name, sizeof(name), SHM_TELEMETRY);
+    int fd = shm_open(name, prot & PROT_WRITE ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    Telemetry* telemetry = mmap(NULL, sizeof(Telemetry), prot, MAP_SHARED, fd, 0);
+    close(fd);
+    if (telemetry == MAP_FAILED) {
+        return NULL;
+    }
+    if (__atomic_load_n(&telemetry->magic, __ATOMIC_ACQUIRE) != TELEMETRY_MAGIC) {
+        munmap(telemetry, sizeof(Telemetry));
+        return NULL;
+    }
+    return telemetry;
+}
+
+Telemetry* telemetry_attach() {
+    Telemetry* telemetry = map_existing(PROT_READ | PROT_WRITE);
+    if (telemetry != NULL && telemetry->master_pid != getppid()) {
+        munmap(telemetry, sizeof(Telemetry));
+        return NULL;
+    }
+    return telemetry;
+}
+
+Telemetry* telemetry_open() {
+    return map_existing(PROT_READ);
+}
+
+void telemetry_detach(Telemetry* telemetry) {
+    if (telemetry == NULL) return;
+    munmap(telemetry, sizeof(Telemetry));
+}
+
+uint64_t telemetry_now_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void telemetry_record(Histogram* histogram, uint64_t ns) {
+    int bucket = ns == 0 ? 0 : 63 - __builtin_clzll(ns);
+    if (bucket >= TELEMETRY_BUCKETS) bucket = TELEMETRY_BUCKETS - 1;
+
+    __atomic_add_fetch(&histogram->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&histogram->sum_ns, ns, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&histogram->max_ns, __ATOMIC_RELAXED);
+    while (ns > max && !__atomic_compare_exchange_n(&histogram->max_ns, &max, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    // count va último: quien lo lea ya ve la muestra en su balde
+    __atomic_add_fetch(&histogram->count, 1, __ATOMIC_RELEASE);
+}
+
+uint64_t telemetry_percentile(const Histogram* histogram, double p) {
+    uint64_t count = __atomic_load_n(&histogram->count, __ATOMIC_ACQUIRE);
+    if (count == 0) return 0;
+
+    uint64_t target = (uint64_t)(p / 100.0 * count);
+    if (target >= count) target = count - 1;
+    uint64_t max = __atomic_load_n(&histogram->max_ns, __ATOMIC_RELAXED);
+    uint64_t seen = 0;
+    for (int i = 0; i < TELEMETRY_BUCKETS - 1; i++) {
+        seen += __atomic_load_n(&histogram->buckets[i], __ATOMIC_RELAXED);
+        if (seen > target) {
+            uint64_t upper = (2ULL << i) - 1;
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
@@ -0,0 +1,79 @@
+// telemetry.h
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "game_state.h"
+
+// Telemetría en vivo (--telemetry): contadores e histogramas de latencia en un segmento propio, aparte de
+// SyncState y de /game_ext. Cada valor lo escribe un solo proceso, pero todas las actualizaciones son
+// atómicas para que `stats` lea números coherentes mientras se juega. Nada de esto toma un lock.
+#define SHM_TELEMETRY "/game_telemetry"
+
+#define TELEMETRY_MAGIC 0x54315054 // "TP1T"
+
+// Histograma logarítmico: el balde i cuenta las muestras de [2^i, 2^(i+1)) ns; el último junta todo
+// lo que pase de 2^(TELEMETRY_BUCKETS-1) ns (~9 minutos)
+#define TELEMETRY_BUCKETS 40
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t buckets[TELEMETRY_BUCKETS];
+} Histogram;
+
+// Lo que mide cada jugador sobre sí mismo
+typedef struct {
+    uint64_t moves_sent;   // movimientos escritos en el FIFO (o dejados en el buzón, si es plugin)
+    uint64_t reads;        // copias del estado
+    uint64_t read_retries; // copias repetidas porque el máster escribió en el medio (seqlock)
+    Histogram reaction;    // publicación del estado que leyó -> movimiento escrito en el FIFO
+    Histogram read_wait;   // espera para entrar al lightswitch (starvation_mutex + game_state_mutex)
+    Histogram read_hold;   // tiempo dentro del lightswitch, con el máster sin poder escribir
+} PlayerTelemetry;
+
+typedef struct {
+    uint32_t magic;
+    pid_t master_pid;
+    uint32_t player_count;
+    char names[MAX_PLAYERS][MAX_NAME];
+
+    uint64_t last_publish_ns; // CLOCK_MONOTONIC de la última publicación del estado
+    uint64_t moves;           // movimientos aplicados (válidos + inválidos)
+    uint64_t invalid_moves;
+    uint64_t discarded_moves; // movimientos con versión descartados sin aplicar (viejos o reemplazados)
+
+    Histogram lock_wait;   // máster esperando game_state_mutex para escribir
+    Histogram hold;        // máster con el estado tomado
+    Histogram view_wait;   // máster esperando print_done
+    Histogram view_render; // vista: desde changes_available hasta print_done
+
+    PlayerTelemetry players[MAX_PLAYERS];
+} Telemetry;
+
+// Máster: crea el segmento en cero. Devuelve NULL (y avisa por stderr) si no se pudo.
+Telemetry* telemetry_create();
+void telemetry_destroy(Telemetry* telemetry);
+
+// Vista y players: NULL si el máster no corre con --telemetry (o el segmento es de otra partida)
+Telemetry* telemetry_attach();
+// stats: abre el segmento de la partida en curso sin ser hijo del máster
+Telemetry* telemetry_open();
+void telemetry_detach(Telemetry* telemetry);
+
+uint64_t telemetry_now_ns();
+
+void telemetry_record(Histogram* histogram, uint64_t ns);
+
+static inline void telemetry_count(uint64_t* counter, uint64_t n) {
+    __atomic_add_fetch(counter, n, __ATOMIC_RELAXED);
+}
+
+// Percentil p (0 a 100) aproximado por el límite superior del balde donde cae
+uint64_t telemetry_percentile(const Histogram* histogram, double p);
+
+#endif // TELEMETRY_H
@@ -1,9 +1,11 @@
 // view.c
+#define _POSIX_C_SOURCE 200112L // clock_nanosleep
 #include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -16,8 +18,12 @@
 #include <stdbool.h>
 #include <string.h>
 #include <limits.h>
+#include <stdarg.h>
 
 #include "game_state.h"
+#include "game_ext.h"
+#include "telemetry.h"
+#include "game_rules.h"
 
 #define BOLD "\033[1m" // Negrita
 #define UNDERLINE "\033[4m" // Subrayado
@@ -77,48 +83,70 @@ const char* get_player_color(int player_id) {
     }
 }
 
-void determine_winner(GameState* state, bool winners[]) {
-    int best_player = -1;
-    unsigned int best_score = 0;
-    unsigned int best_valid_moves = UINT_MAX;
-    unsigned int best_invalid_moves = UINT_MAX;
-
-    // Initialize the winners array
-    for (int i = 0; i < state->player_count; i++) {
-        winners[i] = false;
+// Todo lo que se imprime en un cuadro se arma en este buffer y se manda con un solo write()
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} OutBuffer;
+
+OutBuffer out = {NULL, 0, 0};
+
+void out_reserve(size_t extra) {
+    if (out.len + extra <= out.cap) return;
+    size_t cap = out.cap ? out.cap : 4096;
+    while (cap < out.len + extra) cap *= 2;
+    char* data = realloc(out.data, cap);
+    if (data == NULL) {
+        perror("[view] realloc");
+        exit(1);
     }
+    out.data = data;
+    out.cap = cap;
+}
 
-    // Determine the best player based on the criteria
-    for (int i = 0; i < state->player_count; i++) {
-        Player* player = &state->players[i];
-
-        if (player->score > best_score ||
-            (player->score == best_score && player->valid_moves < best_valid_moves) ||
-            (player->score == best_score && player->valid_moves == best_valid_moves && player->invalid_moves < best_invalid_moves)) {
-            best_score = player->score;
-            best_valid_moves = player->valid_moves;
-            best_invalid_moves = player->invalid_moves;
-            best_player = i;
-        }
-    }
+void out_append(const char* text) {
+    size_t len = strlen(text);
+    out_reserve(len);
+    memcpy(out.data + out.len, text, len);
+    out.len += len;
+}
+
+void out_printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    out_reserve(len + 1);
+    va_start(args, format);
+    vsnprintf(out.data + out.len, len + 1, format, args);
+    va_end(args);
+    out.len += len;
+}
+
+// Mueve el cursor a la fila y columna indicadas (1-indexadas)
+void out_move_cursor(int row, int col) {
+    out_printf("\033[%d;%dH", row, col);
+}
 
-    // Mark the winner or winners in case of a tie
-    if (best_player != -1) {
-        for (int i = 0; i < state->player_count; i++) {
-            Player* player = &state->players[i];
-            if (player->score == best_score &&
-                player->valid_moves == best_valid_moves &&
-                player->invalid_moves == best_invalid_moves) {
-                winners[i] = true;
-            }
+void out_flush() {
+    size_t written = 0;
+    while (written < out.len) {
+        ssize_t n = write(STDOUT_FILENO, out.data + written, out.len - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
         }
+        written += n;
     }
+    out.len = 0;
 }
 
 
 void print_divider(int width) {
     for (int i = 0; i < width; i++) {
-        printf(SYMBOL_DIVIDER);
+        out_append(SYMBOL_DIVIDER);
     }
 }
 
@@ -130,13 +158,30 @@ void print_divider_with_title(int width, const char* title) {
     print_divider(padding);
 
     // Print the title
-    printf("%s", title);
+    out_append(title);
 
     // Print the remaining divider
     print_divider(padding + (width - title_length) % 2);
 }
 
 
+// Texto de una celda del tablero, siempre 4 columnas de ancho
+void render_cell(int cell_value) {
+    static const char* values[10] = { "    ", "  1 ", "  2 ", "  3 ", "  4 ", "  5 ", "  6 ", "  7 ", "  8 ", "  9 " };
+
+    if (cell_value <= 0) {
+        out_append(get_player_color(-cell_value));
+        out_append(" ");
+        out_append(get_player_symbol(-cell_value));
+        out_append(" ");
+        out_append(COLOR_RESET);
+    } else if (cell_value <= 9) {
+        out_append(values[cell_value]);
+    } else {
+        out_printf(" %2d ", cell_value);
+    }
+}
+
 void render_board_section(GameState* state) {
     int width = state->width;
     int height = state->height;
@@ -145,50 +190,82 @@ void render_board_section(GameState* state) {
     int tablero_width = width * 4; // Cada celda tiene 3 espacios, más los bordes
 
     // Imprimir la palabra "TABLERO" centrada
-    printf("%s", BOLD);
+    out_append(BOLD);
     print_divider_with_title(tablero_width, "TABLERO");
-    printf("%s\n", RESET);
+    out_append(RESET "\n");
 
 
 
     // Imprimir las filas del tablero
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
-            int cell_value = state->board[y * width + x];
-            if (cell_value <= 0) {
-                printf("%s %s %s", get_player_color(-cell_value), get_player_symbol(-cell_value), COLOR_RESET);
-            } else {
-                printf(" %2d ", cell_value);
-            }
+            render_cell(state->board[y * width + x]);
         }
-        printf("\n");
+        out_append("\n");
     }
 
     // Imprimir línea divisoria final
     print_divider(tablero_width);
-    printf("\n");
+    out_append("\n");
 }
 
 void print_centered(const char* text, int width) {
     int len = strlen(text);
     if (len >= width) {
-        printf("%.*s", width, text); // Truncar si es más largo
+        out_printf("%.*s", width, text); // Truncar si es más largo
         return;
     }
     int padding = (width - len) / 2;
     int extra = (width - len) % 2; // Por si es impar
-    printf("%*s%s%*s", padding, "", text, padding + extra, "");
+    out_printf("%*s%s%*s", padding, "", text, padding + extra, "");
 }
 
+void render_player_row(GameState* state, int i, bool winners[]) {
+    Player* jugador = &state->players[i];
+    out_append(get_player_color(i));
+
+    char name[16];
+    snprintf(name, sizeof(name), "%s", jugador->name);
+    out_printf("%8s  ", get_player_symbol(i));
+    out_printf("%-16s", name);
+    out_append(winners[i] ? "🏆" : "  ");
+
+    char pid[15];
+    snprintf(pid, sizeof(pid), "%d", jugador->pid);
+    print_centered(pid, 15);
+
+    char score[15];
+    snprintf(score, sizeof(score), "%u", jugador->score);
+    print_centered(score, 15);
+
+    // Imprimir el número de movimientos válidos e inválidos
+    char valid_moves[15];
+    snprintf(valid_moves, sizeof(valid_moves), "%u", jugador->valid_moves);
+    print_centered(valid_moves, 15);
+
+    char invalid_moves[15];
+    snprintf(invalid_moves, sizeof(invalid_moves), "%u", jugador->invalid_moves);
+    print_centered(invalid_moves, 15);
+
+    char position[15];
+    snprintf(position, sizeof(position), "(%02hu,%02hu)", jugador->x, jugador->y);
+    print_centered(position, 15);
+
+    print_centered(jugador->is_blocked ? "SI" : "NO", 15);
+
+    out_append(COLOR_RESET);
+}
+
+#define PLAYERS_WIDTH (26+15*6) // columnas de la tabla de jugadores
+
 void render_players_section(GameState* state) {
     // Imprimir la palabra "JUGADORES" centrada
-    printf("\n\n%s", BOLD);
-    print_divider_with_title(26+15*6, "JUGADORES");
-    printf("%s\n", RESET);
+    out_append("\n\n" BOLD);
+    print_divider_with_title(PLAYERS_WIDTH, "JUGADORES");
+    out_append(RESET "\n");
 
     // Imprimir encabezados centrados
-    printf("%s", RESET);
-    printf("%s", BOLD);
+    out_append(RESET BOLD);
     print_centered("Jugador",   26);
     print_centered("PID",       15);
     print_centered("Puntaje",   15);
@@ -197,61 +274,195 @@ void render_players_section(GameState* state) {
     print_centered("Posicion",  15);
     print_centered("Bloqueado", 15);
     // print_centered("Nombre",    12);
-    printf("%s\n", RESET);
+    out_append(RESET "\n");
 
     bool winners[MAX_PLAYERS] = {false};
     determine_winner(state, winners);
 
     // Imprimir los jugadores
     for (int i = 0; i < state->player_count; i++) {
-        Player* jugador = &state->players[i];
-        printf("%s", get_player_color(i));
-        
-        char name[16];
-        snprintf(name, sizeof(name), "%s", jugador->name);
-        printf("%8s  ", get_player_symbol(i));
-        printf("%-16s", name);
-        printf("%s", winners[i] ? "🏆" : "  ");
-        
-        char pid[15];
-        snprintf(pid, sizeof(pid), "%d", jugador->pid);
-        print_centered(pid, 15);
-
-        char score[15];
-        snprintf(score, sizeof(score), "%u", jugador->score);
-        print_centered(score, 15);
-
-        // Imprimir el número de movimientos válidos e inválidos
-        char valid_moves[15];
-        snprintf(valid_moves, sizeof(valid_moves), "%u", jugador->valid_moves);
-        print_centered(valid_moves, 15);
-
-        char invalid_moves[15];
-        snprintf(invalid_moves, sizeof(invalid_moves), "%u", jugador->invalid_moves);
-        print_centered(invalid_moves, 15);
-        
-        char position[15];
-        sprintf(position, "(%02hu,%02hu)", jugador->x, jugador->y);
-        print_centered(position, 15);
-        
-        print_centered(jugador->is_blocked ? "SI" : "NO", 15);
-
-        printf("%s\n", COLOR_RESET);
+        render_player_row(state, i, winners);
+        out_append("\n");
     }
 
     // Imprimir línea divisoria final
-    print_divider(26+15*6);
-    printf("\n");
+    print_divider(PLAYERS_WIDTH);
+    out_append("\n");
+}
+
+
+// Último cuadro dibujado: a partir del segundo cuadro solo se reescriben las celdas y filas de
+// jugadores que cambiaron, con el cursor posicionado directamente en cada una
+#define PLAYER_ROW_MAX 512
+
+cell_t* drawn_board = NULL;
+char drawn_rows[MAX_PLAYERS][PLAYER_ROW_MAX];
+size_t drawn_row_len[MAX_PLAYERS];
+bool frame_drawn = false;
+struct winsize drawn_size; // tamaño de la terminal en el último cuadro completo
+
+// Líneas de pantalla (1-indexadas) según el layout de render_board_section y render_players_section
+int board_line(int y) { return 2 + y; }
+int player_line(GameState* state, int i) { return state->height + 7 + i; }
+int end_line(GameState* state) { return state->height + 8 + state->player_count; }
+
+// Lee el tamaño de la terminal y dice si el layout entra entero. Si no entra, las líneas largas se
+// parten y lo de abajo se va de pantalla, así que las posiciones de board_line/player_line ya no
+// son las de la pantalla. Si la salida no es una terminal no hay nada que se parta.
+bool layout_fits(GameState* state, struct winsize* size) {
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, size) == -1 || size->ws_row == 0 || size->ws_col == 0) {
+        size->ws_row = 0;
+        size->ws_col = 0;
+        return true;
+    }
+    int columns = state->width * 4 > PLAYERS_WIDTH ? state->width * 4 : PLAYERS_WIDTH;
+    return size->ws_col >= columns && size->ws_row >= end_line(state);
 }
 
+void remember_frame(GameState* state) {
+    memcpy(drawn_board, state->board, sizeof(cell_t) * state->width * state->height);
+
+    bool winners[MAX_PLAYERS] = {false};
+    determine_winner(state, winners);
+    for (int i = 0; i < state->player_count; i++) {
+        size_t start = out.len;
+        render_player_row(state, i, winners);
+        size_t len = out.len - start;
+        if (len > PLAYER_ROW_MAX) len = PLAYER_ROW_MAX;
+        memcpy(drawn_rows[i], out.data + start, len);
+        drawn_row_len[i] = len;
+        out.len = start;
+    }
+}
 
+void render_changes(GameState* state) {
+    int width = state->width;
+    int cells = width * state->height;
+
+    for (int i = 0; i < cells; i++) {
+        int cell_value = state->board[i];
+        if (cell_value == drawn_board[i]) continue;
+
+        out_move_cursor(board_line(i / width), 1 + (i % width) * 4);
+        render_cell(cell_value);
+        drawn_board[i] = cell_value;
+    }
+
+    bool winners[MAX_PLAYERS] = {false};
+    determine_winner(state, winners);
+    for (int i = 0; i < state->player_count; i++) {
+        size_t start = out.len;
+        out_move_cursor(player_line(state, i), 1);
+        size_t row_start = out.len;
+        render_player_row(state, i, winners);
+        size_t len = out.len - row_start;
+
+        if (len == drawn_row_len[i] && memcmp(out.data + row_start, drawn_rows[i], len) == 0) {
+            out.len = start; // la fila no cambió, se descarta
+            continue;
+        }
+        if (len <= PLAYER_ROW_MAX) {
+            memcpy(drawn_rows[i], out.data + row_start, len);
+            drawn_row_len[i] = len;
+        }
+        out_append("\033[K"); // borrar lo que haya quedado de una fila más larga
+    }
+
+    out_move_cursor(end_line(state), 1);
+}
 
 void print_state(GameState* state) {
-    
-    render_board_section(state);
-    render_players_section(state);
+    struct winsize size;
+    bool fits = layout_fits(state, &size);
+    bool resized = size.ws_row != drawn_size.ws_row || size.ws_col != drawn_size.ws_col;
+    if (!frame_drawn || !fits || resized) {
+        // Primer cuadro, terminal que cambió de tamaño o tablero que no entra en la pantalla: se limpia
+        // la pantalla y se dibuja todo
+        out_append("\033[H\033[J"); // \033[H mueve el cursor al inicio, \033[J limpia desde el cursor hasta el final
+        render_board_section(state);
+        render_players_section(state);
+        out_flush();
+        remember_frame(state);
+        frame_drawn = true;
+        drawn_size = size;
+        return;
+    }
+
+    render_changes(state);
+    out_flush();
+}
+
+// Vista asincrónica (--view-fps del máster): se dibuja una copia propia del estado, tomada sin ningún
+// lock con el contador del seqlock, en lugar de leer el segmento mientras el máster espera print_done
+#define SNAPSHOT_TRIES 16 // intentos de copia por cuadro antes de saltearlo
+
+GameState* snapshot = NULL;
+bool snapshot_loaded = false;
+unsigned int snapshot_seq = 0; // movimientos de la bitácora ya aplicados al tablero de la copia
+
+// Copia el último estado completo. El tablero se pone al día con la bitácora si se puede, como en los
+// players, y si no se copia entero. Devuelve false si el máster escribió en el medio.
+bool take_snapshot(GameState* state, GameExt* ext) {
+    unsigned int seq = ext_read_begin(ext);
+    memcpy(snapshot, state, sizeof(GameState));
+
+    unsigned int head = __atomic_load_n(&ext->journal_head, __ATOMIC_ACQUIRE);
+    bool full_copy = true;
+    if (snapshot_loaded && head - snapshot_seq <= JOURNAL_SIZE) {
+        JournalEntry entry;
+        unsigned int applied = snapshot_seq;
+        while (applied != head && ext_journal_read(ext, applied + 1, &entry)) {
+            snapshot->board[entry.to] = -entry.player_id;
+            applied++;
+        }
+        full_copy = applied != head;
+    }
+    if (full_copy) {
+        memcpy(snapshot->board, state->board, sizeof(cell_t) * state->width * state->height);
+    }
+
+    if (ext_read_retry(ext, seq)) {
+        // Aplicar de nuevo la bitácora no cambia nada, pero una copia entera puede haber quedado a medias
+        if (full_copy) snapshot_loaded = false;
+        return false;
+    }
+    snapshot_loaded = true;
+    snapshot_seq = head;
+    return true;
+}
+
+// Dibuja la última copia completa fps veces por segundo hasta ver el estado final
+void run_async(GameState* state, GameExt* ext, Telemetry* telemetry) {
+    long period_ns = 1000000000L / ext->view_fps;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    bool finished = false;
+    while (!finished) {
+        bool copied = false;
+        for (int attempt = 0; attempt < SNAPSHOT_TRIES && !copied; attempt++) {
+            copied = take_snapshot(state, ext);
+        }
+        if (copied) {
+            uint64_t render_ns = telemetry ? telemetry_now_ns() : 0;
+            print_state(snapshot);
+            if (telemetry) telemetry_record(&telemetry->view_render, telemetry_now_ns() - render_ns);
+            finished = snapshot->is_finished;
+        }
 
-    fflush(stdout);
+        // Próximo cuadro; si dibujar tardó más que el período no se intenta recuperar los perdidos
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        next.tv_nsec += period_ns;
+        next.tv_sec += next.tv_nsec / 1000000000L;
+        next.tv_nsec %= 1000000000L;
+        if (next.tv_sec < now.tv_sec || (next.tv_sec == now.tv_sec && next.tv_nsec < now.tv_nsec)) {
+            next = now;
+        }
+        if (!finished) {
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        }
+    }
 }
 
 int main(int argc, char *argv[]) {
@@ -263,21 +474,33 @@ int main(int argc, char *argv[]) {
     unsigned short width = (unsigned short)atoi(argv[1]);
     unsigned short height = (unsigned short)atoi(argv[2]);
 
+    // Si el máster corre con namespace, los nombres llevan el sufijo de GAME_NS
+    char state_name[NS_NAME_MAX], sync_name[NS_NAME_MAX];
+    ns_name(state_name, sizeof(state_name), SHM_STATE);
+    ns_name(sync_name, sizeof(sync_name), SHM_SYNC);
+
     // Abrir memoria compartida del estado del juego
-    int shm_fd = shm_open(SHM_STATE, O_RDONLY, 0);
+    int shm_fd = shm_open(state_name, O_RDONLY, 0);
     if (shm_fd < 0) {
         perror("[view] shm_open state");
         return 1;
     }
 
-    GameState* state = mmap(NULL, sizeof(GameState) + sizeof(int) * width * height, PROT_READ, MAP_SHARED, shm_fd, 0);
+    // Con --prefault/--hugepages el máster pide preparar el mapeo antes de que arranque el juego
+    GameExt* ext = ext_attach(sizeof(cell_t));
+    unsigned int map_flags = ext != NULL ? ext->map_flags : 0;
+    Telemetry* telemetry = telemetry_attach(); // NULL si el máster no corre con --telemetry
+
+    size_t state_size = ext_state_map_size(sizeof(GameState) + sizeof(cell_t) * width * height, map_flags);
+    GameState* state = mmap(NULL, state_size, PROT_READ, MAP_SHARED, shm_fd, 0);
     if (state == MAP_FAILED) {
         perror("[view] mmap state");
         return 1;
     }
+    ext_prepare_mapping(state, state_size, map_flags);
 
     // Abrir memoria compartida de sincronización
-    int sync_fd = shm_open(SHM_SYNC, O_RDWR, 0666);
+    int sync_fd = shm_open(sync_name, O_RDWR, 0666);
     if (sync_fd < 0) {
         perror("[view] shm_open sync");
         return 1;
@@ -291,23 +514,54 @@ int main(int argc, char *argv[]) {
 
     printf("[view] Memorias mapeadas correctamente.\n");
 
-    while (!state->is_finished) {
+    drawn_board = malloc(sizeof(cell_t) * width * height);
+    if (drawn_board == NULL) {
+        perror("[view] malloc");
+        return 1;
+    }
+    ext_prepare_mapping(drawn_board, sizeof(cell_t) * width * height, map_flags & EXT_PREFAULT);
+
+    bool async = ext != NULL && ext->view_fps > 0;
+    if (async) {
+        snapshot = malloc(sizeof(GameState) + sizeof(cell_t) * width * height);
+        if (snapshot == NULL) {
+            perror("[view] malloc");
+            return 1;
+        }
+        ext_prepare_mapping(snapshot, sizeof(GameState) + sizeof(cell_t) * width * height, map_flags & EXT_PREFAULT);
+    }
+    if (map_flags & EXT_PREFAULT) {
+        ext_signal_ready(ext);
+    }
+    fflush(stdout); // lo que se imprimió con printf tiene que salir antes que los cuadros
+
+    if (async) {
+        run_async(state, ext, telemetry);
+    }
+
+    while (!async && !state->is_finished) {
         // Mover el cursor al inicio de la pantalla y limpiar desde ahí
         
         // Esperar a que el máster indique que hay algo que imprimir
         sem_wait(&sync->changes_available);
+        uint64_t render_ns = telemetry ? telemetry_now_ns() : 0;
         
-        // Leer el estado del juego
-        printf("\033[H\033[J"); // \033[H mueve el cursor al inicio, \033[J limpia desde el cursor hasta el final
+        // Leer el estado del juego (solo se redibuja lo que cambió desde el cuadro anterior)
         print_state(state);
         sleep(0); 
+        if (telemetry) telemetry_record(&telemetry->view_render, telemetry_now_ns() - render_ns);
         // Indicar al máster que ya imprimió
         sem_post(&sync->print_done);
     }
 
+    free(drawn_board);
+    free(snapshot);
+    free(out.data);
     printf("[view] Juego terminado.\n");
     // Desmapear memoria compartida
-    if (munmap(state, sizeof(GameState)) == -1) {
+    ext_detach(ext);
+    telemetry_detach(telemetry);
+    if (munmap(state, state_size) == -1) {
         perror("[view] munmap state");
         return 1;
     }